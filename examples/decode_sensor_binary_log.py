@@ -1,6 +1,6 @@
 #!/usr/bin/env python3
 
-import struct, sys, re
+import struct, sys, re, zlib
 
 # 3.7 for dataclasses, 3.8 for walrus (:=) in recovery
 assert (sys.version_info.major >= 3 and sys.version_info.minor >= 8), \
@@ -63,12 +63,25 @@ class Header:
 
 
 class PingViewerLogReader:
-    ''' Structured as a big-endian sequence of
+    ''' The log header is structured as a big-endian sequence of
         size: uint32, data: byte_array[size].
+
+        Version 1 messages use the same structure, a timestamp string followed
+        by the message data.
+        Version 2 messages are saved as little-endian records of
+        type: uint8, flags: uint8, reserved: uint16, size: uint32,
+        timestamp_us: uint64, data: byte_array[size].
+        The timestamp is monotonic, in microseconds since the start of the log.
+        Block records contain a sequence of message records, compressed with
+        zlib and prefixed by the big-endian uint32 uncompressed size (qCompress).
     '''
 
     # int32 values used in message header
     INT = struct.Struct('>i')
+    # version 2 record header
+    RECORD = struct.Struct('<BBHIQ')
+    RECORD_TYPE_PACKET = 0
+    RECORD_TYPE_BLOCK = 1
     # big-endian uint32 'size' parsed for every timestamp and message
     #  -> only compile and calcsize once
     UINT = struct.Struct('>I')
@@ -112,6 +125,40 @@ class PingViewerLogReader:
     def unpack_string(self, file: IO[Any]):
         return self.unpack_array(file).decode(self.ENCODING)
 
+    @classmethod
+    def format_timestamp_us(cls, timestamp_us: int):
+        ''' Returns a version 2 timestamp as 'hh:mm:ss.ffffff'. '''
+        seconds, microseconds = divmod(timestamp_us, 1_000_000)
+        minutes, seconds = divmod(seconds, 60)
+        hours, minutes = divmod(minutes, 60)
+        return f'{hours:02d}:{minutes:02d}:{seconds:02d}.{microseconds:06d}'
+
+    def unpack_records(self, file: IO[Any]):
+        ''' Unpacks a version 2 record, yields each message it contains. '''
+        data = file.read(self.RECORD.size)
+        if len(data) != self.RECORD.size:
+            raise EOFError('No more records.')
+        record_type, _flags, _reserved, size, timestamp_us = \
+            self.RECORD.unpack_from(data)
+        payload = file.read(size)
+        if len(payload) != size:
+            raise EOFError('Log file ends in the middle of a record.')
+
+        if record_type == self.RECORD_TYPE_PACKET:
+            yield (self.format_timestamp_us(timestamp_us), payload)
+        elif record_type == self.RECORD_TYPE_BLOCK:
+            block = zlib.decompress(payload[self.UINT.size:])
+            position = 0
+            while position + self.RECORD.size <= len(block):
+                _type, _flags, _reserved, size, timestamp_us = \
+                    self.RECORD.unpack_from(block, position)
+                position += self.RECORD.size
+                yield (self.format_timestamp_us(timestamp_us),
+                       block[position:position + size])
+                position += size
+        else:
+            raise ValueError(f'Unknown record type: {record_type}')
+
     def unpack_message(self, file: IO[Any]):
         timestamp = self.unpack_string(file)
         message = self.unpack_array(file)
@@ -185,14 +232,19 @@ class PingViewerLogReader:
         """ Creates an iterator for efficient reading of self.filename.
 
         Yields (timestamp, message) pairs for decoding.
+        Timestamps are 'hh:mm:ss.zzz' strings for version 1 logs, and
+            'hh:mm:ss.ffffff' strings since the start of the log for version 2.
 
         """
         with open(self.filename, "rb") as file:
             self.unpack_header(file)
             while "data available":
                 try:
-                    yield self.unpack_message(file)
-                except struct.error:
+                    if self.header.version >= 2:
+                        yield from self.unpack_records(file)
+                    else:
+                        yield self.unpack_message(file)
+                except (struct.error, EOFError):
                     break # reading complete
 
     def parser(self, message_ids: Set[int] = {1300, 2300, 2301}):
@@ -9,6 +9,8 @@ from typing import Iterable, Tuple
 class PingViewerLogWriter:
     INT = PingViewerLogReader.INT
     UINT = PingViewerLogReader.UINT
+    # messages are written with timestamp strings, as in version 1 logs
+    VERSION = 1
 
     def __init__(self, filename: str,
                  messages: Iterable[Tuple[str, PingMessage]],
@@ -45,6 +47,8 @@ class PingViewerLogWriter:
 
     @classmethod
     def pack_message(cls, timestamp: str, message: PingMessage):
+        # version 2 timestamps have microseconds, version 1 uses milliseconds
+        timestamp = timestamp[:timestamp.index('.') + 4]
         return (cls.pack_string(timestamp)
                 + cls.pack_array(message.pack_msg_data()))
 
@@ -52,7 +56,7 @@ class PingViewerLogWriter:
     def pack_header(cls, header: Header):
         return b''.join((
             cls.pack_string(header.string),
-            cls.INT.pack(header.version),
+            cls.INT.pack(cls.VERSION),
             *(cls.pack_string(
                 getattr(header.ping_viewer_build_info, build_info))
               for build_info in PingViewerBuildInfo.__annotations__),\
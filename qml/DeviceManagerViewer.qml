@@ -249,7 +249,12 @@ PingPopup {
                         hoverEnabled: true
                         enabled: rectDelegate.connectionStatus != DeviceManagerViewer.ConnectionStatus.ConfigurationIsRequired
                         onClicked: {
-                            DeviceManager.connectLink(connection);
+                            // Connected sensors continue to run, the selected one is shown
+                            if (connected) {
+                                DeviceManager.setPrimarySensor(connection);
+                            } else {
+                                DeviceManager.connectLink(connection);
+                            }
                         }
                     }
 
@@ -108,6 +108,37 @@ ColumnLayout {
                     onCheckedChanged: SettingsManager.realTimeReplay = checked
                 }
 
+                Label {
+                    text: "Replay speed:"
+                    visible: SettingsManager.replayMenu
+                }
+
+                ComboBox {
+                    id: replaySpeedCB
+
+                    // Speed 0 plays the log as fast as possible
+                    property var speeds: [0.25, 0.5, 1, 2, 4, 8, 16, 0]
+
+                    visible: SettingsManager.replayMenu
+                    Layout.columnSpan: 4
+                    Layout.fillWidth: true
+                    model: speeds.map((speed) => {
+                        return speed ? speed + "x" : "Maximum";
+                    })
+                    currentIndex: Math.max(0, speeds.indexOf(SettingsManager.replaySpeed))
+                    onActivated: SettingsManager.replaySpeed = speeds[index]
+                }
+
+                CheckBox {
+                    id: compressSensorLogChB
+
+                    text: "Compress sensor logs"
+                    checked: SettingsManager.compressSensorLog
+                    Layout.columnSpan: 5
+                    Layout.fillWidth: true
+                    onCheckedChanged: SettingsManager.compressSensorLog = checked
+                }
+
                 Loader {
                     sourceComponent: DeviceManager.primarySensor ? DeviceManager.primarySensor.sensorVisualizer().displaySettings : null
                     Layout.columnSpan: 5
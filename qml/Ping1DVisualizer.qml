@@ -18,9 +18,9 @@ Item {
     property alias displaySettings: displaySettings
     property var ping: DeviceManager.primarySensor
 
-    function draw(points, confidence, initialPoint, length, distance) {
-        waterfall.draw(points, confidence, initialPoint, length, distance);
-        chart.draw(points, length + initialPoint, initialPoint);
+    function draw(profile) {
+        waterfall.draw(profile);
+        chart.draw(profile.samples, profile.length + profile.initialPoint, profile.initialPoint);
     }
 
     function setDepth(depth) {
@@ -65,9 +65,8 @@ Item {
 
     Connections {
         target: ping
-        onPointsChanged: {
-            // Move from mm to m
-            root.draw(ping.points, ping.confidence, ping.start_mm * 0.001, ping.length_mm * 0.001, ping.distance * 0.001);
+        onProfileChanged: {
+            root.draw(profile);
         }
         onDistanceChanged: {
             root.setDepth(ping.distance / 1000);
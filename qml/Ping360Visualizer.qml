@@ -58,7 +58,7 @@ Item {
         onTriggered: {
             shapeSpinner.angle = (ping.angle + 0.25) * 180 / 200;
             if (chart.visible)
-                chart.draw(ping.data, ping.range, 0);
+                chart.draw(ping.profile.samples, ping.range, 0);
 
         }
     }
@@ -76,8 +76,8 @@ Item {
             clear();
         }
 
-        function onDataChanged() {
-            waterfall.draw(ping.data, ping.angle, 0, ping.range, ping.angular_speed, ping.sectorSize);
+        function onProfileChanged(profile) {
+            waterfall.draw(profile, ping.angular_speed, ping.sectorSize);
         }
 
         target: ping
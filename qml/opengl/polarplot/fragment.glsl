@@ -63,8 +63,9 @@ void main() {
     polar.y = polar.y * polarFactor + (1.0 - polar.y) * (1.0 - polarFactor);
 
     //Sample at positions with a slight offset
-    vec4 one = texture2D(src, vec2(polar.x - xOffset, polar.y));
-    vec4 two = texture2D(src, polar);
-    vec4 three = texture2D(src, vec2(polar.x + xOffset, polar.y));
+    //The source texture has the radius in the horizontal axis and the angle in the vertical axis
+    vec4 one = texture2D(src, vec2(polar.y, polar.x - xOffset));
+    vec4 two = texture2D(src, polar.yx);
+    vec4 three = texture2D(src, vec2(polar.y, polar.x + xOffset));
     gl_FragColor = max(max(one, two), three);
 }
@@ -0,0 +1,531 @@
+#define private public
+#define protected public
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSemaphore>
+#include <QTemporaryDir>
+#include <QtCharts/QLineSeries>
+
+#include "abstractlink.h"
+#include "asynclogwriter.h"
+#include "pingchecksum.h"
+#include "pingparserext.h"
+#include "polarplot.h"
+#include "processlog.h"
+#include "util.h"
+#include "waterfallplot.h"
+#include "waterfallrenderer.h"
+
+#include "benchmark.h"
+
+#include "ping-message-ping360.h"
+
+namespace {
+// Heap allocations of all threads, the render workers are included
+std::atomic<quint64> allocations {0};
+
+// Profiles of each measurement, the synthetic profiles are reused
+const int numberOfProfiles = 2048;
+const int numberOfSamples = 1200;
+
+// Profiles drawn before waiting for the render worker, it should be smaller than the render queue
+const int renderBatchSize = 256;
+// Profiles received by the polar plot in each pending interval
+const int polarBatchSize = 4;
+
+// Averages can change by a fraction of an allocation with the internal caches of Qt
+const double allocationSlack = 0.5;
+
+/**
+ * @brief Write a log with a packet for each message, 20Hz
+ *
+ * @param fileName
+ * @param messages
+ * @param numberOfPackets
+ * @param compress
+ * @return bool false if the log can't be created or a packet was dropped
+ */
+bool writeLog(const QString& fileName, const QVector<QByteArray>& messages, int numberOfPackets, bool compress)
+{
+    LogSensorStruct logSensorStruct;
+    logSensorStruct.init();
+    AsyncLogWriter writer;
+    if (!writer.open(fileName, logSensorStruct, compress)) {
+        return false;
+    }
+    for (int i = 0; i < numberOfPackets; i++) {
+        writer.write(messages[i % messages.size()], i * 50000ull);
+    }
+    writer.close();
+    return writer.statistics().dropped == 0;
+}
+
+/**
+ * @brief Wait until the render worker runs all queued jobs and process the frame events
+ *
+ * @param renderer
+ */
+void waitRenderer(WaterfallRenderer& renderer)
+{
+    QSemaphore done;
+    renderer.render([&done](QImage&, QRegion&) { done.release(); });
+    done.acquire();
+    QCoreApplication::processEvents();
+}
+}
+
+// Qt containers allocate with malloc, it's replaced to count them together with operator new
+#ifdef __GLIBC__
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* pointer, size_t size);
+
+void* malloc(size_t size) noexcept
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) noexcept
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* pointer, size_t size) noexcept
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_realloc(pointer, size);
+}
+}
+#else
+void* operator new(std::size_t size)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* pointer = std::malloc(size ? size : 1)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+void operator delete(void* pointer, std::size_t) noexcept { std::free(pointer); }
+#endif
+
+void Benchmark::initTestCase()
+{
+    // Low intensity noise with a single echo, like Ping360SimulationLink
+    QRandomGenerator random(42);
+    for (int counter = 0; counter < 64; counter++) {
+        Profile::Data data;
+        data.angle = counter % 400;
+        data.initialPoint = 0;
+        data.length = 50 + 0.1 * (counter % 10);
+        data.distance = data.length / 2;
+        data.confidence = 100;
+        data.samples.resize(numberOfSamples);
+        const float stop1 = numberOfSamples / 2.0 - 10 * qSin(counter / 10.0);
+        const float stop2 = 3 * numberOfSamples / 5.0 + 6 * qCos(counter / 5.5);
+        for (int i = 0; i < numberOfSamples; i++) {
+            float point;
+            if (i < stop1) {
+                point = 0.1 * random.bounded(256);
+            } else if (i < stop2) {
+                point = 255 * ((-4.0 / qPow(stop2 - stop1, 2.0)) * qPow(i - stop1 - (stop2 - stop1) / 2.0, 2.0) + 1.0);
+            } else {
+                point = 0.45 * random.bounded(256);
+            }
+            data.samples[i] = static_cast<char>(qBound(0.0f, point, 255.0f));
+        }
+        _profiles.append(Profile(std::move(data)));
+    }
+
+    // Ping360 device data message of each profile, used by the protocol and log benchmarks
+    ping360_device_data deviceData(numberOfSamples);
+    for (const Profile& profile : qAsConst(_profiles)) {
+        deviceData.set_angle(static_cast<uint16_t>(profile.angle()));
+        deviceData.set_number_of_samples(numberOfSamples);
+        deviceData.set_data_length(numberOfSamples);
+        for (int i = 0; i < numberOfSamples; i++) {
+            deviceData.set_data_at(i, static_cast<uint8_t>(profile.samples().at(i)));
+        }
+        deviceData.updateChecksum();
+        _messages.append(QByteArray(reinterpret_cast<const char*>(deviceData.msgData), deviceData.msgDataLength()));
+    }
+
+    const QString tolerance = qEnvironmentVariable("PING_BENCHMARK_TOLERANCE");
+    if (!tolerance.isEmpty()) {
+        bool ok = false;
+        _tolerance = tolerance.toDouble(&ok);
+        QVERIFY2(ok && _tolerance >= 0, qPrintable(QString("Invalid tolerance: %1").arg(tolerance)));
+    }
+
+    const QString baselinePath = qEnvironmentVariable("PING_BENCHMARK_BASELINE");
+    if (baselinePath.isEmpty()) {
+        return;
+    }
+
+    QFile file(baselinePath);
+    QVERIFY2(file.open(QIODevice::ReadOnly), qPrintable(QString("Failed to open baseline: %1").arg(baselinePath)));
+    const QJsonObject baseline = QJsonDocument::fromJson(file.readAll()).object();
+    for (auto it = baseline.constBegin(); it != baseline.constEnd(); it++) {
+        const QJsonObject result = it.value().toObject();
+        _baseline[it.key()] = {result[QStringLiteral("nsPerProfile")].toDouble(),
+            result[QStringLiteral("allocationsPerProfile")].toDouble()};
+    }
+}
+
+void Benchmark::cleanupTestCase()
+{
+    const QString outputPath = qEnvironmentVariable("PING_BENCHMARK_OUTPUT");
+    if (outputPath.isEmpty()) {
+        return;
+    }
+
+    QJsonObject output;
+    for (auto it = _results.constBegin(); it != _results.constEnd(); it++) {
+        output[it.key()] = QJsonObject {
+            {QStringLiteral("nsPerProfile"), it.value().nanosecondsPerProfile},
+            {QStringLiteral("allocationsPerProfile"), it.value().allocationsPerProfile},
+        };
+    }
+
+    QFile file(outputPath);
+    QVERIFY2(file.open(QIODevice::WriteOnly), qPrintable(QString("Failed to open output: %1").arg(outputPath)));
+    file.write(QJsonDocument(output).toJson());
+}
+
+Benchmark::Result Benchmark::measure(int profileCount, const std::function<void()>& function)
+{
+    function();
+
+    QElapsedTimer timer;
+    const quint64 initialAllocations = allocations.load();
+    timer.start();
+    function();
+    const qint64 elapsed = timer.nsecsElapsed();
+    const quint64 finalAllocations = allocations.load();
+
+    return {static_cast<double>(elapsed) / profileCount,
+        static_cast<double>(finalAllocations - initialAllocations) / profileCount};
+}
+
+void Benchmark::report(const Result& result)
+{
+    QString name = QTest::currentTestFunction();
+    if (QTest::currentDataTag()) {
+        name += QStringLiteral(":%1").arg(QTest::currentDataTag());
+    }
+    _results[name] = result;
+    qInfo().noquote() << QString("%1: %2 ns/profile, %3 allocations/profile")
+                             .arg(name)
+                             .arg(result.nanosecondsPerProfile, 0, 'f', 0)
+                             .arg(result.allocationsPerProfile, 0, 'f', 2);
+    QTest::setBenchmarkResult(result.nanosecondsPerProfile, QTest::WalltimeNanoseconds);
+
+    if (!_baseline.contains(name)) {
+        return;
+    }
+
+    const Result& baseline = _baseline[name];
+    const double maximumTime = baseline.nanosecondsPerProfile * (1 + _tolerance);
+    const double maximumAllocations = baseline.allocationsPerProfile * (1 + _tolerance) + allocationSlack;
+    QVERIFY2(result.nanosecondsPerProfile <= maximumTime,
+        qPrintable(QString("Time regression: %1 ns/profile, baseline %2 ns/profile")
+                       .arg(result.nanosecondsPerProfile, 0, 'f', 0)
+                       .arg(baseline.nanosecondsPerProfile, 0, 'f', 0)));
+    QVERIFY2(result.allocationsPerProfile <= maximumAllocations,
+        qPrintable(QString("Allocation regression: %1 allocations/profile, baseline %2 allocations/profile")
+                       .arg(result.allocationsPerProfile, 0, 'f', 2)
+                       .arg(baseline.allocationsPerProfile, 0, 'f', 2)));
+}
+
+void Benchmark::pingChecksum_data()
+{
+    QTest::addColumn<bool>("vectorized");
+
+    QTest::newRow("vectorized") << true;
+    QTest::newRow("byteByByte") << false;
+}
+
+void Benchmark::pingChecksum()
+{
+    QFETCH(bool, vectorized);
+
+    // The sums are accumulated, otherwise the compiler could remove the calls
+    quint64 sum = 0;
+    const Result result = measure(numberOfProfiles, [&] {
+        for (int i = 0; i < numberOfProfiles; i++) {
+            const QByteArray& message = _messages[i % _messages.size()];
+            const auto data = reinterpret_cast<const uint8_t*>(message.constData());
+            if (vectorized) {
+                sum += PingChecksum::calculate(data, message.size());
+            } else {
+                uint16_t checksum = 0;
+                for (int j = 0; j < message.size(); j++) {
+                    checksum += data[j];
+                }
+                sum += checksum;
+            }
+        }
+    });
+    QVERIFY(sum != 0);
+    report(result);
+}
+
+void Benchmark::pingParser_data()
+{
+    QTest::addColumn<bool>("bulk");
+
+    QTest::newRow("bulk") << true;
+    QTest::newRow("byteByByte") << false;
+}
+
+void Benchmark::pingParser()
+{
+    QFETCH(bool, bulk);
+
+    // Received in chunks like a serial or UDP link
+    const int chunkSize = 1460;
+    QByteArray stream;
+    for (int i = 0; i < numberOfProfiles; i++) {
+        stream.append(_messages[i % _messages.size()]);
+    }
+    QVector<QByteArray> chunks;
+    for (int i = 0; i < stream.size(); i += chunkSize) {
+        chunks.append(stream.mid(i, chunkSize));
+    }
+
+    PingParserExt parser;
+    int received = 0;
+    connect(&parser, &Parser::newMessage, this, [&received] { received++; });
+    const Result result = measure(numberOfProfiles, [&] {
+        if (bulk) {
+            for (const QByteArray& chunk : qAsConst(chunks)) {
+                parser.parseBuffer(chunk);
+            }
+        } else {
+            for (const char byte : qAsConst(stream)) {
+                received += parser.parseByte(byte) == Parser::NEW_MESSAGE;
+            }
+        }
+    });
+    QCOMPARE(received, 2 * numberOfProfiles);
+    report(result);
+}
+
+void Benchmark::polarPlotDraw()
+{
+    PolarPlot plot;
+    waitRenderer(plot._renderer);
+
+    const Result result = measure(numberOfProfiles, [&] {
+        for (int i = 0; i < numberOfProfiles; i++) {
+            plot.draw(_profiles[i % _profiles.size()], 1, 360);
+            // The pending timer is not used, the batches have always the same size
+            if ((i + 1) % polarBatchSize == 0) {
+                plot.drawPendingProfiles();
+            }
+            if ((i + 1) % renderBatchSize == 0) {
+                waitRenderer(plot._renderer);
+            }
+        }
+    });
+    report(result);
+}
+
+void Benchmark::sensorLogSeek_data()
+{
+    QTest::addColumn<bool>("compress");
+
+    QTest::newRow("raw") << false;
+    QTest::newRow("compressed") << true;
+}
+
+void Benchmark::sensorLogSeek()
+{
+    QFETCH(bool, compress);
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString fileName = dir.filePath(QStringLiteral("log.bin"));
+    QVERIFY(writeLog(fileName, _messages, numberOfProfiles, compress));
+
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QDataStream in(&file);
+    LogSensorStruct header;
+    in >> header;
+    QVERIFY(header.isValid());
+    const qint64 firstPacketOffset = file.pos();
+    file.close();
+
+    ProcessLog processLog;
+    processLog.setLogFile(fileName, firstPacketOffset, header.version, AbstractLink::timeFormat());
+    QVERIFY(processLog.indexAll());
+    QCOMPARE(processLog.index().size(), numberOfProfiles);
+
+    // Packets are read in random order, the compressed blocks are not reused between reads
+    QRandomGenerator random(42);
+    qint64 bytes = 0;
+    const Result result = measure(numberOfProfiles, [&] {
+        for (int i = 0; i < numberOfProfiles; i++) {
+            bytes += processLog.readPacket(random.bounded(numberOfProfiles)).size();
+        }
+    });
+    QVERIFY(bytes > 0);
+    report(result);
+}
+
+void Benchmark::sensorLogWrite_data()
+{
+    QTest::addColumn<bool>("compress");
+
+    QTest::newRow("raw") << false;
+    QTest::newRow("compressed") << true;
+}
+
+void Benchmark::sensorLogWrite()
+{
+    QFETCH(bool, compress);
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString fileName = dir.filePath(QStringLiteral("log.bin"));
+
+    // The log is closed in each run, the time includes the writer thread
+    bool written = true;
+    const Result result = measure(numberOfProfiles, [&] {
+        written &= writeLog(fileName, _messages, numberOfProfiles, compress);
+    });
+    QVERIFY(written);
+
+    qint64 messagesSize = 0;
+    for (int i = 0; i < numberOfProfiles; i++) {
+        messagesSize += _messages[i % _messages.size()].size();
+    }
+    qInfo().noquote() << QString("%1: %2 compression ratio")
+                             .arg(QTest::currentDataTag())
+                             .arg(messagesSize / static_cast<double>(QFileInfo(fileName).size()), 0, 'f', 2);
+    report(result);
+}
+
+void Benchmark::utilUpdate()
+{
+    QtCharts::QLineSeries serie;
+    QtCharts::QLineSeries serieInv;
+
+    // Same calls of Chart.qml
+    const Result result = measure(numberOfProfiles, [&] {
+        for (int i = 0; i < numberOfProfiles; i++) {
+            const Profile& profile = _profiles[i % _profiles.size()];
+            const float depth = profile.initialPoint() + profile.length();
+            Util::self()->update(&serie, profile.samples(), profile.initialPoint(), depth, 0, depth, 1);
+            Util::self()->update(&serieInv, profile.samples(), profile.initialPoint(), depth, 0, depth, -1);
+        }
+    });
+    report(result);
+}
+
+void Benchmark::waterfallPlotDraw()
+{
+    WaterfallPlot plot;
+    waitRenderer(plot._renderer);
+
+    const Result result = measure(numberOfProfiles, [&] {
+        for (int i = 0; i < numberOfProfiles; i++) {
+            plot.draw(_profiles[i % _profiles.size()]);
+            if ((i + 1) % renderBatchSize == 0) {
+                waitRenderer(plot._renderer);
+            }
+        }
+    });
+    report(result);
+}
+
+void Benchmark::waterfallColumn_data()
+{
+    QTest::addColumn<bool>("scanLine");
+
+    QTest::newRow("scanLine") << true;
+    QTest::newRow("setPixel") << false;
+}
+
+void Benchmark::waterfallColumn()
+{
+    QFETCH(bool, scanLine);
+
+    // Same image of WaterfallPlot, each profile is resampled to the entire column
+    WaterfallPlot plot;
+    QImage image(500, 3500, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::transparent);
+    const int height = image.height();
+    QVector<uint8_t> samples(height);
+    QVector<float> values(height);
+    QVector<uint32_t> pixels(height);
+
+    const Result result = measure(numberOfProfiles, [&] {
+        for (int i = 0; i < numberOfProfiles; i++) {
+            const QByteArray& profileSamples = _profiles[i % _profiles.size()].samples();
+            const auto profileData = reinterpret_cast<const uint8_t*>(profileSamples.constData());
+            const float factor = profileSamples.size() / static_cast<float>(height);
+            const int column = i % image.width();
+            if (scanLine) {
+                for (int row = 0; row < height; row++) {
+                    samples[row] = profileData[static_cast<int>(factor * row)];
+                }
+                plot.drawColumn(image, column, samples.constData(), height);
+            } else {
+                // Paint path before the direct writes: normalized values, a color buffer and a setPixel per row
+                for (int row = 0; row < height; row++) {
+                    values[row] = profileData[static_cast<int>(factor * row)] / 255.0f;
+                }
+                plot.valuesToRGBA(values.constData(), pixels.data(), height);
+                for (int row = 0; row < height; row++) {
+                    image.setPixel(column, row, pixels[row]);
+                }
+            }
+        }
+    });
+    QVERIFY(image.pixel(0, height / 2) != 0);
+    report(result);
+}
+
+void Benchmark::waterfallValueToRGB()
+{
+    PolarPlot plot;
+
+    // The colors are accumulated, otherwise the compiler could remove the calls
+    QRgb sum = 0;
+    const Result result = measure(numberOfProfiles, [&] {
+        for (int i = 0; i < numberOfProfiles; i++) {
+            const QByteArray& samples = _profiles[i % _profiles.size()].samples();
+            for (const char sample : samples) {
+                sum += plot.valueToRGB(static_cast<uint8_t>(sample) / 255.0f).rgba();
+            }
+        }
+    });
+    QVERIFY(sum != 0);
+    report(result);
+}
+
+int main(int argc, char* argv[])
+{
+    // The plots are not shown, the benchmark can run without a display server
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+
+    QApplication app(argc, argv);
+    Benchmark benchmark;
+    return QTest::qExec(&benchmark, argc, argv);
+}
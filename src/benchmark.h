@@ -0,0 +1,127 @@
+#include <functional>
+
+#include <QHash>
+#include <QtTest/QtTest>
+
+#include "profile.h"
+
+/**
+ * @brief Rendering, protocol and log benchmarks, the waterfall plots and chart series are fed with synthetic
+ *  profiles offscreen
+ *  Each benchmark reports the time and the number of heap allocations per profile.
+ *  The results are compared with a baseline when PING_BENCHMARK_BASELINE has the path of a previous result file,
+ *  a benchmark fails when it's slower or allocates more than the baseline by PING_BENCHMARK_TOLERANCE (default 0.2).
+ *  The results are saved in PING_BENCHMARK_OUTPUT when defined.
+ *  Benchmarks with data rows are saved as "benchmark:row".
+ *  The protocol and log benchmarks use the Ping360 device data message of each profile.
+ *
+ */
+class Benchmark : public QObject {
+    Q_OBJECT
+private slots:
+    /**
+     * @brief Create the synthetic profiles and load the baseline
+     *
+     */
+    void initTestCase();
+
+    /**
+     * @brief Save the results
+     *
+     */
+    void cleanupTestCase();
+
+    /**
+     * @brief Benchmark the ping checksum of a message with the vectorized sum and the byte by byte sum
+     *
+     */
+    void pingChecksum_data();
+    void pingChecksum();
+
+    /**
+     * @brief Benchmark the ping parser with the bulk parser and the byte by byte state machine
+     *
+     */
+    void pingParser_data();
+    void pingParser();
+
+    /**
+     * @brief Benchmark polar plot draw, including the render worker
+     *
+     */
+    void polarPlotDraw();
+
+    /**
+     * @brief Benchmark random packet reads of an indexed log, with and without compression
+     *
+     */
+    void sensorLogSeek_data();
+    void sensorLogSeek();
+
+    /**
+     * @brief Benchmark sensor log writes, with and without compression
+     *  The compression ratio is also reported
+     *
+     */
+    void sensorLogWrite_data();
+    void sensorLogWrite();
+
+    /**
+     * @brief Benchmark chart series update of profiles and inverted profiles
+     *
+     */
+    void utilUpdate();
+
+    /**
+     * @brief Benchmark waterfall plot draw, including the render worker
+     *
+     */
+    void waterfallPlotDraw();
+
+    /**
+     * @brief Benchmark the paint of a waterfall column, with the direct scan line writes and the previous
+     *  per pixel path, to compare them in the same run
+     *
+     */
+    void waterfallColumn_data();
+    void waterfallColumn();
+
+    /**
+     * @brief Benchmark the color of each sample of a profile
+     *
+     */
+    void waterfallValueToRGB();
+
+private:
+    /**
+     * @brief Measurement of a benchmark
+     *
+     */
+    struct Result {
+        double nanosecondsPerProfile = 0;
+        double allocationsPerProfile = 0;
+    };
+
+    /**
+     * @brief Run a function that processes a number of profiles, it's called once before the measurement to warm up
+     *  caches and buffers
+     *
+     * @param profileCount
+     * @param function
+     * @return Result
+     */
+    static Result measure(int profileCount, const std::function<void()>& function);
+
+    /**
+     * @brief Report the result of the current benchmark and compare it with the baseline
+     *
+     * @param result
+     */
+    void report(const Result& result);
+
+    QHash<QString, Result> _baseline;
+    QVector<QByteArray> _messages;
+    QVector<Profile> _profiles;
+    QHash<QString, Result> _results;
+    double _tolerance = 0.2;
+};
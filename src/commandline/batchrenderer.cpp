@@ -0,0 +1,156 @@
+#include "batchrenderer.h"
+#include "filelink.h"
+#include "filemanager.h"
+#include "linkconfiguration.h"
+#include "logger.h"
+#include "ping.h"
+#include "ping360.h"
+#include "polarplot.h"
+#include "replayscheduler.h"
+#include "waterfallplot.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QThread>
+
+PING_LOGGING_CATEGORY(BATCHRENDERER, "ping.batchrenderer");
+
+BatchRenderer::BatchRenderer(const QStringList& paths, QObject* parent)
+    : QObject(parent)
+    , _failures(0)
+    , _maximumJobs(std::max(1, QThread::idealThreadCount()))
+    , _outputFolder(FileManager::self()->getPathFrom(FileManager::Pictures).toLocalFile())
+    , _queue(logFiles(paths))
+{
+}
+
+QStringList BatchRenderer::logFiles(const QStringList& paths)
+{
+    QStringList files;
+    for (const auto& path : paths) {
+        const QFileInfo info(path);
+        if (!info.isDir()) {
+            files.append(info.absoluteFilePath());
+            continue;
+        }
+
+        for (const auto& file : QDir(path).entryInfoList({"*.bin"}, QDir::Files, QDir::Name)) {
+            files.append(file.absoluteFilePath());
+        }
+    }
+    return files;
+}
+
+QString BatchRenderer::uniqueImageName(const QString& path)
+{
+    const QString baseName = QFileInfo(path).completeBaseName();
+    QString imageName = baseName;
+    for (int i = 2; _imageNames.contains(imageName); i++) {
+        imageName = QStringLiteral("%1_%2").arg(baseName).arg(i);
+    }
+    if (imageName != baseName) {
+        qCWarning(BATCHRENDERER) << "Image name already used by other log:" << path << "will be saved as" << imageName;
+    }
+    _imageNames.insert(imageName);
+    return imageName;
+}
+
+int BatchRenderer::exec()
+{
+    if (_queue.isEmpty()) {
+        qCWarning(BATCHRENDERER) << "No logs to render.";
+        return 1;
+    }
+
+    qCInfo(BATCHRENDERER) << "Rendering" << _queue.size() << "logs," << _maximumJobs << "at the same time.";
+    startJobs();
+    if (!_jobs.empty()) {
+        _loop.exec();
+    }
+
+    qCInfo(BATCHRENDERER) << "Rendering done with" << _failures << "failures.";
+    return _failures ? 1 : 0;
+}
+
+void BatchRenderer::startJobs()
+{
+    while (static_cast<int>(_jobs.size()) < _maximumJobs && !_queue.isEmpty()) {
+        const QString path = _queue.takeFirst();
+        if (!startJob(path)) {
+            _failures++;
+        }
+    }
+
+    if (_jobs.empty()) {
+        _loop.quit();
+    }
+}
+
+bool BatchRenderer::startJob(const QString& path)
+{
+    LinkConfiguration linkConfiguration {LinkType::File, {path, "r"}};
+    const auto deviceType = FileLink::staticLogSensorStruct(linkConfiguration).sensor.type.ping;
+    if (deviceType == PingDeviceType::UNKNOWN) {
+        qCWarning(BATCHRENDERER) << "Log does not provide a valid sensor type:" << path;
+        return false;
+    }
+    linkConfiguration.setDeviceType(deviceType);
+
+    _jobs.emplace_back();
+    const auto job = std::prev(_jobs.end());
+    job->path = path;
+    job->imageName = uniqueImageName(path);
+
+    // Same plots and draw calls of the sensor visualizers
+    if (deviceType == PingDeviceType::PING1D) {
+        auto ping = new Ping();
+        auto plot = new WaterfallPlot();
+        connect(ping, &Ping::profileChanged, plot, [plot](const Profile& profile) { plot->draw(profile); });
+        job->sensor.reset(ping);
+        job->plot.reset(plot);
+    } else {
+        auto ping360 = new Ping360();
+        auto plot = new PolarPlot();
+        connect(ping360, &Ping360::profileChanged, plot, [ping360, plot](const Profile& profile) {
+            plot->draw(profile, ping360->angular_speed(), ping360->sectorSize());
+        });
+        connect(ping360, &Ping360::rangeChanged, plot, &PolarPlot::clear);
+        connect(ping360, &Ping360::sectorSizeChanged, plot, &PolarPlot::clear);
+        job->sensor.reset(ping360);
+        job->plot.reset(plot);
+    }
+    connect(job->sensor.get(), &PingSensor::profileChanged, this, [job] { job->profiles++; });
+
+    job->sensor->connectLink(linkConfiguration);
+    auto fileLink = qobject_cast<FileLink*>(job->sensor->link());
+    if (!fileLink || !fileLink->isOpen()) {
+        qCWarning(BATCHRENDERER) << "Failed to open log:" << path;
+        _jobs.erase(job);
+        return false;
+    }
+
+    // The link is destroyed with the sensor, the job can't finish inside its signal
+    connect(fileLink, &FileLink::endOfLog, this, [this, job] { finishJob(job); }, Qt::QueuedConnection);
+    fileLink->setReplaySpeed(ReplayScheduler::asFastAsPossible);
+    qCDebug(BATCHRENDERER) << "Rendering log:" << path;
+    return true;
+}
+
+void BatchRenderer::finishJob(std::list<Job>::iterator job)
+{
+    const QString fileName = QStringLiteral("%1/%2.png").arg(_outputFolder, job->imageName);
+
+    const QImage image = job->profiles ? job->plot->grabImage() : QImage();
+    if (image.isNull()) {
+        qCWarning(BATCHRENDERER) << "Log without profiles:" << job->path;
+        _failures++;
+    } else if (!image.save(fileName)) {
+        qCWarning(BATCHRENDERER) << "Failed to save image:" << fileName;
+        _failures++;
+    } else {
+        qCInfo(BATCHRENDERER) << "Log" << job->path << "rendered to" << fileName;
+    }
+
+    _jobs.erase(job);
+    startJobs();
+}
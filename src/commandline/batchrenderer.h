@@ -0,0 +1,112 @@
+#pragma once
+
+#include <list>
+#include <memory>
+
+#include <QEventLoop>
+#include <QObject>
+#include <QSet>
+#include <QStringList>
+
+#include "pingsensor.h"
+#include "waterfall.h"
+
+/**
+ * @brief Render sensor logs to images without the user interface
+ *  Each log is played as fast as possible by its own file link thread, the profiles are parsed by a sensor and drawn
+ *  in a plot that rasterizes in its own render thread. Several logs are rendered at the same time, one per core.
+ *  The plot image of each log is saved in the pictures folder when the log ends, logs with the same name in different
+ *  folders get a numbered image name.
+ */
+class BatchRenderer : public QObject {
+    Q_OBJECT
+public:
+    /**
+     * @brief Construct a new Batch Renderer object
+     *
+     * @param paths log files or folders with log files
+     * @param parent
+     */
+    BatchRenderer(const QStringList& paths, QObject* parent = nullptr);
+
+    /**
+     * @brief Destroy the Batch Renderer object
+     *
+     */
+    ~BatchRenderer() = default;
+
+    /**
+     * @brief Render all logs, it returns when all logs are done
+     *
+     * @return int 0 if all images were saved, 1 otherwise
+     */
+    int exec();
+
+    /**
+     * @brief Set the folder of the images, the default is the pictures folder
+     *
+     * @param folder
+     */
+    void setOutputFolder(const QString& folder) { _outputFolder = folder; }
+
+private:
+    Q_DISABLE_COPY(BatchRenderer)
+
+    /**
+     * @brief Log being rendered
+     *
+     */
+    struct Job {
+        QString path;
+        QString imageName;
+        // The sensor is destroyed first, it draws in the plot
+        std::unique_ptr<Waterfall> plot;
+        std::unique_ptr<PingSensor> sensor;
+        int profiles = 0;
+    };
+
+    /**
+     * @brief Return the log files of a list of files and folders
+     *
+     * @param paths
+     * @return QStringList
+     */
+    static QStringList logFiles(const QStringList& paths);
+
+    /**
+     * @brief Return an image name for a log that is not used by other log of the same batch
+     *
+     * @param path
+     * @return QString
+     */
+    QString uniqueImageName(const QString& path);
+
+    /**
+     * @brief Start the next logs while there are free cores
+     *
+     */
+    void startJobs();
+
+    /**
+     * @brief Start to play a log
+     *
+     * @param path
+     * @return true if the log is playing
+     */
+    bool startJob(const QString& path);
+
+    /**
+     * @brief Save the image of a log that ended and start the next logs
+     *
+     * @param job
+     */
+    void finishJob(std::list<Job>::iterator job);
+
+    int _failures;
+    QSet<QString> _imageNames;
+    std::list<Job> _jobs;
+    QEventLoop _loop;
+    int _maximumJobs;
+    QString _outputFolder;
+    QStringList _queue;
+};
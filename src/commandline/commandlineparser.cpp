@@ -19,8 +19,7 @@ CommandLineParser::CommandLineParser(const QCoreApplication& app)
     process(app);
 
     for (const auto& optionStruct : _optionsStruct) {
-        QString result = value(optionStruct.option);
-        if (!result.isEmpty()) {
+        for (const QString& result : values(optionStruct.option)) {
             qCDebug(COMMANDLINEPARSER) << QStringLiteral("Valid option: %1 [%2]: %3")
                                               .arg(optionStruct.option.names().first(),
                                                   optionStruct.option.description(), result);
@@ -26,6 +26,13 @@ public:
      */
     ~CommandLineParser() = default;
 
+    /**
+     * @brief Return the logs that should be rendered to images without the user interface
+     *
+     * @return QStringList log files or folders with log files
+     */
+    QStringList renderFiles() const { return _renderFiles; }
+
 private:
     struct OptionStruct {
         QCommandLineOption option;
@@ -34,13 +41,16 @@ private:
 
     QList<OptionStruct> _optionsStruct {
         {
-            {{"connect", "c"}, "Connect directly with the input.", "connectionString"
-#if defined(PING360_SPEED_TEST)
-                ,
-                "Ping360:6"
-#endif
-            },
+            {{"connect", "c"}, "Connect directly with the input, it can be repeated to connect multiple sensors.",
+                "connectionString"},
             [](const QString& result) { DeviceManager::self()->connectLinkDirectly(LinkConfiguration {result}); },
         },
+        {
+            {{"render", "r"}, "Render sensor logs to images without the user interface, it can be repeated.",
+                "logFileOrFolder"},
+            [this](const QString& result) { _renderFiles.append(result); },
+        },
     };
+
+    QStringList _renderFiles;
 };
@@ -96,17 +96,103 @@ void DeviceManager::connectLink(LinkConfiguration* linkConf)
     _sensors[Name][objIndex] = PingHelper::nameFromDeviceType(linkConf->deviceType());
     qCDebug(DEVICEMANAGER) << "Connecting with sensor:" << _sensors[Name][objIndex].toString() << *linkConf;
 
-    // We could use a single Ping instance, but since we are going to support multiple devices
-    // this pointer will hold everything for us
+    // A sensor is replaced when connected again, and a log replaces the log being played
+    int sensorIndex = connectedSensorIndex(*linkConf);
+    if (sensorIndex < 0 && linkConf->type() == LinkType::File) {
+        for (int i {0}; i < _connectedSensors.size(); i++) {
+            if (_connectedSensors[i].linkConfiguration.type() == LinkType::File) {
+                sensorIndex = i;
+                break;
+            }
+        }
+    }
+    if (sensorIndex >= 0) {
+        disconnectLink(&_connectedSensors[sensorIndex].linkConfiguration);
+    }
+
+    // Each sensor has its own link, parser, log and link thread
+    QSharedPointer<Sensor> sensor;
     if (linkConf->deviceType() == PingDeviceType::PING1D) {
-        _primarySensor.reset(new Ping());
+        sensor.reset(new Ping());
     } else {
-        _primarySensor.reset(new Ping360());
+        sensor.reset(new Ping360());
     }
+    _connectedSensors.append({*linkConf, sensor});
 
+    _primarySensor = sensor;
     emit primarySensorChanged();
+    emit sensorsChanged();
     _primarySensor->connectLink(*linkConf);
-    _sensors[Connected][objIndex] = true;
+    setConnected(*linkConf, true);
+}
+
+void DeviceManager::disconnectLink(LinkConfiguration* linkConf)
+{
+    const int sensorIndex = connectedSensorIndex(*linkConf);
+    if (sensorIndex < 0) {
+        qCWarning(DEVICEMANAGER) << "There is no sensor connected with:" << *linkConf;
+        return;
+    }
+
+    qCDebug(DEVICEMANAGER) << "Disconnecting sensor:" << *linkConf;
+    // The configuration is copied since it's removed with the sensor
+    const LinkConfiguration sensorLinkConf = _connectedSensors[sensorIndex].linkConfiguration;
+    const auto sensor = _connectedSensors.takeAt(sensorIndex).sensor;
+    setConnected(sensorLinkConf, false);
+
+    if (_primarySensor == sensor) {
+        _primarySensor = _connectedSensors.isEmpty() ? QSharedPointer<Sensor>() : _connectedSensors.last().sensor;
+        emit primarySensorChanged();
+    }
+    emit sensorsChanged();
+}
+
+void DeviceManager::setPrimarySensor(LinkConfiguration* linkConf)
+{
+    const int sensorIndex = connectedSensorIndex(*linkConf);
+    if (sensorIndex < 0) {
+        qCWarning(DEVICEMANAGER) << "There is no sensor connected with:" << *linkConf;
+        return;
+    }
+
+    if (_primarySensor == _connectedSensors[sensorIndex].sensor) {
+        return;
+    }
+
+    _primarySensor = _connectedSensors[sensorIndex].sensor;
+    emit primarySensorChanged();
+}
+
+QVariantList DeviceManager::sensors() const
+{
+    QVariantList sensors;
+    for (const auto& connectedSensor : _connectedSensors) {
+        sensors.append(QVariant::fromValue(connectedSensor.sensor.get()));
+    }
+    return sensors;
+}
+
+int DeviceManager::connectedSensorIndex(const LinkConfiguration& linkConf) const
+{
+    for (int i {0}; i < _connectedSensors.size(); i++) {
+        if (_connectedSensors[i].linkConfiguration == linkConf) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void DeviceManager::setConnected(const LinkConfiguration& linkConf, bool connected)
+{
+    for (int i {0}; i < _sensors[Connection].size(); i++) {
+        auto sensorLinkConf = _sensors[Connection][i].value<QSharedPointer<LinkConfiguration>>().get();
+        if (*sensorLinkConf == linkConf) {
+            _sensors[Connected][i] = connected;
+            const auto indexRow = index(i);
+            emit dataChanged(indexRow, indexRow, {Connected});
+            return;
+        }
+    }
 }
 
 void DeviceManager::connectLinkDirectly(const LinkConfiguration& linkConfiguration)
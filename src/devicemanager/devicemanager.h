@@ -55,7 +55,8 @@ public:
 
     /**
      * @brief Create a sensor object with the desired link configuration
-     *  This sensor object will be available via primarySensor
+     *  This sensor object will be available via primarySensor, the other connected sensors continue to work.
+     *  A sensor already connected with the same configuration is replaced, and only one log is played at a time.
      *
      * @param linkConf
      */
@@ -78,6 +79,14 @@ public:
     Q_INVOKABLE void connectLinkDirectly(AbstractLinkNamespace::LinkType connType, const QStringList& connString,
         PingEnumNamespace::PingDeviceType deviceType);
 
+    /**
+     * @brief Disconnect and destroy the sensor connected with a link configuration
+     *  If it's the primary sensor, the last connected sensor becomes the primary sensor
+     *
+     * @param linkConf
+     */
+    Q_INVOKABLE void disconnectLink(LinkConfiguration* linkConf);
+
     /**
      * @brief Play a log file
      *
@@ -149,6 +158,21 @@ public:
     QVariant primarySensor() const { return QVariant::fromValue(_primarySensor.get()); }
     Q_PROPERTY(QVariant primarySensor READ primarySensor NOTIFY primarySensorChanged)
 
+    /**
+     * @brief Set the primary sensor, by its link configuration
+     *
+     * @param linkConf
+     */
+    Q_INVOKABLE void setPrimarySensor(LinkConfiguration* linkConf);
+
+    /**
+     * @brief Return all connected sensors, in connection order
+     *
+     * @return QVariantList
+     */
+    QVariantList sensors() const;
+    Q_PROPERTY(QVariantList sensors READ sensors NOTIFY sensorsChanged)
+
     /**
      * @brief Remove all found items and create a clear model once again
      *
@@ -159,6 +183,7 @@ signals:
     void countChanged();
     void sensorChanged(int objIndex);
     void primarySensorChanged();
+    void sensorsChanged();
 
 private:
     Q_DISABLE_COPY(DeviceManager)
@@ -169,6 +194,22 @@ private:
      */
     DeviceManager();
 
+    /**
+     * @brief Return the index of the connected sensor with a link configuration
+     *
+     * @param linkConf
+     * @return int -1 if there is no sensor connected with it
+     */
+    int connectedSensorIndex(const LinkConfiguration& linkConf) const;
+
+    /**
+     * @brief Set the connected state of a link configuration in the model
+     *
+     * @param linkConf
+     * @param connected
+     */
+    void setConnected(const LinkConfiguration& linkConf, bool connected);
+
     /**
      * @brief Update list of available links
      *
@@ -194,6 +235,13 @@ private:
         {DetectorName, "detectorName"},
     };
 
+    // Sensor connected with a link configuration
+    struct ConnectedSensor {
+        LinkConfiguration linkConfiguration;
+        QSharedPointer<Sensor> sensor;
+    };
+    QVector<ConnectedSensor> _connectedSensors;
+
     QSharedPointer<Sensor> _primarySensor;
     ProtocolDetector* _detector;
     QThread _detectorThread;
@@ -14,6 +14,7 @@ FileManager::FileManager()
     , _guiLogDir(_fmDir.dir.filePath(QStringLiteral("Gui_Log")), fileTypeExtension[TXT])
     , _picturesDir(_fmDir.dir.filePath(QStringLiteral("Pictures")), fileTypeExtension[PICTURE])
     , _sensorLogDir(_fmDir.dir.filePath(QStringLiteral("Sensor_Log")), fileTypeExtension[BINARY])
+    , _logCatalog(_sensorLogDir.dir.filePath(QStringLiteral(".logcatalog")))
 {
     QQmlEngine::setObjectOwnership(this, QQmlEngine::CppOwnership);
 
@@ -62,11 +63,25 @@ QUrl FileManager::getPathFrom(FileManager::Folder folderType)
     return QUrl::fromLocalFile(folder->dir.path());
 }
 
+void FileManager::updateLogCatalog()
+{
+    QFileInfoList logs;
+    for (const auto& file : getFilesFrom(SensorLog)) {
+        // Sidecar index files are in the same folder
+        if (file.fileName().endsWith(_sensorLogDir.extension)) {
+            logs.append(file);
+        }
+    }
+    _logCatalog.setFiles(logs);
+}
+
 QObject* FileManager::qmlSingletonRegister(QQmlEngine* engine, QJSEngine* scriptEngine)
 {
-    Q_UNUSED(engine)
     Q_UNUSED(scriptEngine)
 
+    // The catalog is built in the background when the user interface starts
+    engine->addImageProvider(QStringLiteral("logcatalog"), new LogCatalogImageProvider(self()->logCatalog()));
+    self()->updateLogCatalog();
     return self();
 }
 
@@ -7,6 +7,8 @@
 #include <QStringList>
 #include <QUrl>
 
+#include "logcatalog.h"
+
 Q_DECLARE_LOGGING_CATEGORY(FILEMANAGER)
 
 class QJSEngine;
@@ -64,6 +66,21 @@ public:
      */
     Q_INVOKABLE QUrl getPathFrom(FileManager::Folder folderType);
 
+    /**
+     * @brief Return the catalog of the sensor logs folder
+     *
+     * @return LogCatalog*
+     */
+    LogCatalog* logCatalog() { return &_logCatalog; }
+    Q_PROPERTY(LogCatalog* logCatalog READ logCatalog CONSTANT)
+
+    /**
+     * @brief Update the log catalog with the actual files of the sensor logs folder
+     *  New or modified logs are read in the background
+     *
+     */
+    Q_INVOKABLE void updateLogCatalog();
+
     /**
      * @brief Return a pointer of this singleton to the qml register function
      *
@@ -124,6 +141,8 @@ private:
     FolderStruct _guiLogDir;
     FolderStruct _picturesDir;
     FolderStruct _sensorLogDir;
+    // The cache is a hidden file of the sensor logs folder, it's not listed with the logs
+    LogCatalog _logCatalog;
 
     /**
      * @brief Manage all folders access
@@ -0,0 +1,447 @@
+#include <algorithm>
+#include <array>
+
+#include <QDataStream>
+#include <QDir>
+#include <QSaveFile>
+#include <QUrl>
+#include <QtConcurrent>
+#include <QtEndian>
+
+#include "abstractlink.h"
+#include "decimation.h"
+#include "logcatalog.h"
+#include "logger.h"
+#include "logkeyframes.h"
+#include "logsensorstruct.h"
+#include "ping-message-all.h"
+#include "processlog.h"
+
+PING_LOGGING_CATEGORY(LOGCATALOG, "ping.logcatalog");
+
+const QByteArray LogCatalog::_cacheMagic = QByteArrayLiteral("PVLOGCAT");
+
+namespace {
+// File name of the logs created by FileManager, other logs use the modification time to find the start time
+const QString logFileNameFormat = QStringLiteral("yyyyMMdd-hhmmsszzz");
+
+/**
+ * @brief Return the length of the ping message in the start of a packet
+ *
+ * @param data
+ * @return int 0 if the packet does not have a complete message
+ */
+int messageLength(const QByteArray& data)
+{
+    if (data.size() < ping_message::headerLength || data[0] != 'B' || data[1] != 'R') {
+        return 0;
+    }
+
+    const auto bytes = reinterpret_cast<const uchar*>(data.constData());
+    const int length
+        = ping_message::headerLength + qFromLittleEndian<quint16>(bytes + 2) + ping_message::checksumLength;
+    return length <= data.size() ? length : 0;
+}
+
+/**
+ * @brief Return the firmware version of a device information packet
+ *
+ * @param data
+ * @return QString empty if the packet does not have the firmware version
+ */
+QString firmwareVersion(const QByteArray& data)
+{
+    const int length = messageLength(data);
+    if (!length) {
+        return {};
+    }
+
+    ping_message message(reinterpret_cast<const uint8_t*>(data.constData()), length);
+    if (message.message_id() == CommonId::DEVICE_INFORMATION) {
+        const auto& deviceInformation = *static_cast<const common_device_information*>(&message);
+        return QStringLiteral("%1.%2.%3")
+            .arg(deviceInformation.firmware_version_major())
+            .arg(deviceInformation.firmware_version_minor())
+            .arg(deviceInformation.firmware_version_patch());
+    }
+    if (message.message_id() == Ping1dId::FIRMWARE_VERSION) {
+        const auto& firmware = *static_cast<const ping1d_firmware_version*>(&message);
+        return QStringLiteral("%1.%2").arg(firmware.firmware_version_major()).arg(firmware.firmware_version_minor());
+    }
+    return {};
+}
+
+/**
+ * @brief Resample the profile of a packet to a thumbnail column
+ *
+ * @param data
+ * @param column output with LogCatalog::thumbnailHeight samples
+ * @return true if the packet has a profile
+ * @return false
+ */
+bool profileColumn(const QByteArray& data, uint8_t* column)
+{
+    const int length = messageLength(data);
+    if (!length) {
+        return false;
+    }
+
+    ping_message message(reinterpret_cast<const uint8_t*>(data.constData()), length);
+    const uint8_t* samples = nullptr;
+    int numberOfSamples = 0;
+    switch (message.message_id()) {
+    case Ping1dId::PROFILE: {
+        const auto& profile = *static_cast<const ping1d_profile*>(&message);
+        samples = profile.profile_data();
+        numberOfSamples = profile.profile_data_length();
+        break;
+    }
+    case Ping360Id::DEVICE_DATA: {
+        const auto& deviceData = *static_cast<const ping360_device_data*>(&message);
+        samples = deviceData.data();
+        numberOfSamples = deviceData.data_length();
+        break;
+    }
+    case Ping360Id::AUTO_DEVICE_DATA: {
+        const auto& autoDeviceData = *static_cast<const ping360_auto_device_data*>(&message);
+        samples = autoDeviceData.data();
+        numberOfSamples = autoDeviceData.data_length();
+        break;
+    }
+    default:
+        return false;
+    }
+
+    // The sample length of corrupted messages can be bigger than the message
+    const int available = length - ping_message::checksumLength - static_cast<int>(samples - message.msgData);
+    numberOfSamples = std::min(numberOfSamples, available);
+    if (numberOfSamples <= 0) {
+        return false;
+    }
+
+    Decimation::resampleMax(samples, numberOfSamples, column, LogCatalog::thumbnailHeight);
+    return true;
+}
+}
+
+LogCatalog::LogCatalog(const QString& cacheFileName, QObject* parent)
+    : QAbstractListModel(parent)
+    , _cacheLoaded(false)
+    , _cacheFileName(cacheFileName)
+    , _nextFilesPending(false)
+{
+    connect(&_scanWatcher, &QFutureWatcher<void>::finished, this, &LogCatalog::scanFinished);
+}
+
+LogCatalog::~LogCatalog()
+{
+    _scan.cancel();
+    _scan.waitForFinished();
+}
+
+void LogCatalog::setFiles(const QFileInfoList& files)
+{
+    // The entries can't change while the logs are read
+    if (_scan.isRunning()) {
+        _nextFiles = files;
+        _nextFilesPending = true;
+        return;
+    }
+
+    if (!_cacheLoaded) {
+        loadCache();
+        _cacheLoaded = true;
+    }
+
+    QVector<Entry> entries;
+    entries.reserve(files.size());
+    _pending.clear();
+    for (const auto& file : files) {
+        const QString path = file.absoluteFilePath();
+        const qint64 modifiedMs = file.lastModified().toMSecsSinceEpoch();
+        const Entry* cached = entry(path);
+        if (cached && cached->ready && cached->size == file.size() && cached->modifiedMs == modifiedMs) {
+            entries.append(*cached);
+            continue;
+        }
+
+        Entry newEntry;
+        newEntry.path = path;
+        newEntry.size = file.size();
+        newEntry.modifiedMs = modifiedMs;
+        entries.append(newEntry);
+        _pending.append(file);
+    }
+
+    // Without pending logs, the entries only change if logs were removed
+    const bool removed = entries.size() != _entries.size();
+
+    beginResetModel();
+    _entries = entries;
+    _rows.clear();
+    for (int row = 0; row < _entries.size(); row++) {
+        _rows.insert(_entries[row].path, row);
+    }
+    endResetModel();
+
+    if (_pending.isEmpty()) {
+        if (removed) {
+            saveCache();
+        }
+        return;
+    }
+
+    qCDebug(LOGCATALOG) << "Reading" << _pending.size() << "of" << _entries.size() << "logs.";
+    _scan = QtConcurrent::map(_pending, [this](const QFileInfo& file) {
+        const Entry entry = describe(file);
+        QMetaObject::invokeMethod(this, [this, entry] { updateEntry(entry); }, Qt::QueuedConnection);
+    });
+    _scanWatcher.setFuture(_scan);
+    emit scanningChanged();
+}
+
+const LogCatalog::Entry* LogCatalog::entry(const QString& path) const
+{
+    const int row = _rows.value(path, -1);
+    return row < 0 ? nullptr : &_entries[row];
+}
+
+LogCatalog::Entry LogCatalog::describe(const QFileInfo& file)
+{
+    Entry entry;
+    entry.path = file.absoluteFilePath();
+    entry.size = file.size();
+    entry.modifiedMs = file.lastModified().toMSecsSinceEpoch();
+    entry.ready = true;
+
+    QFile logFile(entry.path);
+    if (!logFile.open(QIODevice::ReadOnly)) {
+        qCWarning(LOGCATALOG) << "Failed to open log:" << entry.path << logFile.errorString();
+        return entry;
+    }
+
+    QDataStream in(&logFile);
+    LogSensorStruct logSensorStruct;
+    in >> logSensorStruct;
+    if (!logSensorStruct.isValid()) {
+        qCDebug(LOGCATALOG) << "Log file does not contain a valid header:" << entry.path;
+        return entry;
+    }
+    const qint64 firstPacketOffset = logFile.pos();
+    logFile.close();
+
+    // The sidecar index is used when valid, otherwise the packets are indexed in this thread
+    ProcessLog log;
+    log.setLogFile(entry.path, firstPacketOffset, logSensorStruct.version, AbstractLink::timeFormat());
+    if (!log.indexAll()) {
+        return entry;
+    }
+
+    const LogIndex& index = log.index();
+    entry.valid = true;
+    entry.sensorType = static_cast<int>(logSensorStruct.sensor.type.ping);
+    entry.packets = index.size();
+    if (!index.isEmpty()) {
+        entry.durationMs = (index.at(index.size() - 1).timestampUs - index.at(0).timestampUs) / 1000;
+    }
+    entry.startTime = QDateTime::fromString(file.completeBaseName(), logFileNameFormat);
+    if (!entry.startTime.isValid()) {
+        entry.startTime = file.lastModified().addMSecs(-entry.durationMs);
+    }
+
+    QVector<int> profiles;
+    for (int packet = 0; packet < index.size(); packet++) {
+        const quint16 messageId = index.at(packet).messageId;
+        if (messageId == Ping1dId::PROFILE) {
+            profiles.append(packet);
+        } else if (entry.firmware.isEmpty()
+            && (messageId == CommonId::DEVICE_INFORMATION || messageId == Ping1dId::FIRMWARE_VERSION)) {
+            entry.firmware = firmwareVersion(log.readPacket(packet));
+        }
+    }
+
+    // Ping360 thumbnails show the last sweep, with the latest profile of each angle
+    if (profiles.isEmpty()) {
+        LogKeyframes keyframes;
+        keyframes.update(index, index.size());
+        profiles = keyframes.latestPackets(index, index.size());
+        std::sort(profiles.begin(), profiles.end(),
+            [&index](int first, int second) { return index.at(first).angle < index.at(second).angle; });
+    }
+    if (profiles.isEmpty()) {
+        return entry;
+    }
+
+    entry.thumbnail = QByteArray(thumbnailWidth * thumbnailHeight, 0);
+    std::array<uint8_t, thumbnailHeight> column;
+    for (int x = 0; x < thumbnailWidth; x++) {
+        const int packet = profiles[static_cast<qint64>(x) * profiles.size() / thumbnailWidth];
+        if (!profileColumn(log.readPacket(packet), column.data())) {
+            continue;
+        }
+        for (int y = 0; y < thumbnailHeight; y++) {
+            entry.thumbnail[y * thumbnailWidth + x] = static_cast<char>(column[y]);
+        }
+    }
+    return entry;
+}
+
+QImage LogCatalog::thumbnailImage(const Entry& entry)
+{
+    if (entry.thumbnail.size() != thumbnailWidth * thumbnailHeight) {
+        return {};
+    }
+
+    return QImage(reinterpret_cast<const uchar*>(entry.thumbnail.constData()), thumbnailWidth, thumbnailHeight,
+        thumbnailWidth, QImage::Format_Grayscale8)
+        .copy();
+}
+
+QVariant LogCatalog::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= _entries.size()) {
+        return {};
+    }
+
+    const Entry& entry = _entries[index.row()];
+    switch (role) {
+    case FileName:
+        return QFileInfo(entry.path).fileName();
+    case FilePath:
+        return entry.path;
+    case Ready:
+        return entry.ready;
+    case Valid:
+        return entry.valid;
+    case SensorName:
+        return entry.valid ? PingHelper::nameFromDeviceType(static_cast<PingDeviceType>(entry.sensorType))
+                           : QString();
+    case Firmware:
+        return entry.firmware;
+    case StartTime:
+        return entry.startTime;
+    case EndTime:
+        return entry.startTime.addMSecs(entry.durationMs);
+    case Duration:
+        return entry.durationMs;
+    case Packets:
+        return entry.packets;
+    case Thumbnail:
+        // The modification time changes the url, QML does not use the cached image of an old log
+        if (entry.thumbnail.isEmpty()) {
+            return QString();
+        }
+        return QStringLiteral("image://logcatalog/%1?%2")
+            .arg(QString::fromLatin1(QUrl::toPercentEncoding(entry.path)))
+            .arg(entry.modifiedMs);
+    default:
+        return {};
+    }
+}
+
+void LogCatalog::updateEntry(const Entry& entry)
+{
+    const int row = _rows.value(entry.path, -1);
+    if (row < 0) {
+        return;
+    }
+
+    _entries[row] = entry;
+    emit dataChanged(index(row), index(row));
+}
+
+void LogCatalog::scanFinished()
+{
+    // The entries were posted before the finished signal, all of them are updated
+    qCDebug(LOGCATALOG) << "Logs read:" << _pending.size();
+    _pending.clear();
+    saveCache();
+    emit scanningChanged();
+
+    if (_nextFilesPending) {
+        _nextFilesPending = false;
+        setFiles(_nextFiles);
+    }
+}
+
+void LogCatalog::loadCache()
+{
+    QFile file(_cacheFileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+
+    QDataStream in(&file);
+    QByteArray magic(_cacheMagic.size(), 0);
+    quint32 version = 0;
+    quint32 count = 0;
+    in.readRawData(magic.data(), magic.size());
+    in >> version >> count;
+    if (magic != _cacheMagic || version != _cacheVersion) {
+        qCDebug(LOGCATALOG) << "Ignoring log catalog cache with a different layout:" << _cacheFileName;
+        return;
+    }
+
+    _entries.clear();
+    _rows.clear();
+    for (quint32 i = 0; i < count; i++) {
+        Entry entry;
+        entry.ready = true;
+        in >> entry.path >> entry.size >> entry.modifiedMs >> entry.valid >> entry.sensorType >> entry.firmware
+            >> entry.startTime >> entry.durationMs >> entry.packets >> entry.thumbnail;
+        if (in.status() != QDataStream::Ok) {
+            qCWarning(LOGCATALOG) << "Log catalog cache is truncated:" << _cacheFileName;
+            break;
+        }
+        _rows.insert(entry.path, _entries.size());
+        _entries.append(entry);
+    }
+    qCDebug(LOGCATALOG) << "Log catalog cache loaded with" << _entries.size() << "logs.";
+}
+
+void LogCatalog::saveCache() const
+{
+    QDir().mkpath(QFileInfo(_cacheFileName).path());
+
+    // The old cache is kept if the application is closed while saving
+    QSaveFile file(_cacheFileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qCWarning(LOGCATALOG) << "Failed to save log catalog cache:" << _cacheFileName << file.errorString();
+        return;
+    }
+
+    const auto count
+        = std::count_if(_entries.cbegin(), _entries.cend(), [](const Entry& entry) { return entry.ready; });
+    QDataStream out(&file);
+    out.writeRawData(_cacheMagic.constData(), _cacheMagic.size());
+    out << _cacheVersion << static_cast<quint32>(count);
+    for (const auto& entry : _entries) {
+        if (!entry.ready) {
+            continue;
+        }
+        out << entry.path << entry.size << entry.modifiedMs << entry.valid << entry.sensorType << entry.firmware
+            << entry.startTime << entry.durationMs << entry.packets << entry.thumbnail;
+    }
+    file.commit();
+}
+
+LogCatalogImageProvider::LogCatalogImageProvider(const LogCatalog* catalog)
+    : QQuickImageProvider(QQuickImageProvider::Image)
+    , _catalog(catalog)
+{
+}
+
+QImage LogCatalogImageProvider::requestImage(const QString& id, QSize* size, const QSize& requestedSize)
+{
+    const QString path = QUrl::fromPercentEncoding(id.section('?', 0, 0).toLatin1());
+    const LogCatalog::Entry* entry = _catalog->entry(path);
+    QImage image = entry ? LogCatalog::thumbnailImage(*entry) : QImage();
+    if (size) {
+        *size = image.size();
+    }
+
+    if (!image.isNull() && requestedSize.width() > 0 && requestedSize.height() > 0) {
+        image = image.scaled(requestedSize, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+    }
+    return image;
+}
@@ -0,0 +1,235 @@
+#pragma once
+
+#include <QAbstractListModel>
+#include <QDateTime>
+#include <QFileInfo>
+#include <QFutureWatcher>
+#include <QHash>
+#include <QImage>
+#include <QLoggingCategory>
+#include <QQuickImageProvider>
+#include <QVector>
+
+Q_DECLARE_LOGGING_CATEGORY(LOGCATALOG)
+
+/**
+ * @brief Catalog of the sensor logs, with the information necessary to browse them without opening each log
+ *  The information of each log is read by background threads and saved in a cache file, keyed by the log path, size
+ *  and modification time. Only new or modified logs are read again, the cached logs are available immediately.
+ *  Logs without a valid sidecar index are read entirely once, to find the number of packets and the duration.
+ */
+class LogCatalog : public QAbstractListModel {
+    Q_OBJECT
+public:
+    enum {
+        FileName = Qt::UserRole,
+        FilePath,
+        Ready,
+        Valid,
+        SensorName,
+        Firmware,
+        StartTime,
+        EndTime,
+        Duration,
+        Packets,
+        Thumbnail,
+    };
+
+    // Thumbnail columns are profiles over time, or angles of the last sweep for Ping360 logs
+    static constexpr int thumbnailWidth = 64;
+    // Thumbnail rows are the maximum of the profile samples of each row, closest samples on top
+    static constexpr int thumbnailHeight = 32;
+
+    /**
+     * @brief Information of a single log
+     *
+     */
+    struct Entry {
+        QString path;
+        qint64 size = 0;
+        qint64 modifiedMs = 0;
+        // The information below is only available after the log is read
+        bool ready = false;
+        // The log has a valid header
+        bool valid = false;
+        int sensorType = 0;
+        QString firmware;
+        QDateTime startTime;
+        qint64 durationMs = 0;
+        int packets = 0;
+        // 8 bits samples, thumbnailWidth x thumbnailHeight in row order, empty if the log has no profiles
+        QByteArray thumbnail;
+    };
+
+    /**
+     * @brief Construct a new Log Catalog object
+     *
+     * @param cacheFileName
+     * @param parent
+     */
+    LogCatalog(const QString& cacheFileName, QObject* parent = nullptr);
+
+    /**
+     * @brief Destroy the Log Catalog object, logs being read are cancelled
+     *
+     */
+    ~LogCatalog();
+
+    /**
+     * @brief Update the catalog with a list of log files
+     *  The cached logs are available immediately, new or modified logs are read in the background
+     *
+     * @param files
+     */
+    void setFiles(const QFileInfoList& files);
+
+    /**
+     * @brief Return the entry of a log, by path
+     *
+     * @param path
+     * @return const Entry* nullptr if the log is not in the catalog
+     */
+    const Entry* entry(const QString& path) const;
+
+    /**
+     * @brief Read the information of a log file
+     *  This can be called by any thread
+     *
+     * @param file
+     * @return Entry
+     */
+    static Entry describe(const QFileInfo& file);
+
+    /**
+     * @brief Return the image of a log thumbnail
+     *
+     * @param entry
+     * @return QImage null if the log has no thumbnail
+     */
+    static QImage thumbnailImage(const Entry& entry);
+
+    /**
+     * @brief Return true while logs are read in the background
+     *
+     * @return bool
+     */
+    bool scanning() const { return _scan.isRunning(); }
+    Q_PROPERTY(bool scanning READ scanning NOTIFY scanningChanged)
+
+    /**
+     * @brief Return data
+     *
+     * @param index
+     * @param role
+     * @return QVariant
+     */
+    QVariant data(const QModelIndex& index, int role) const override;
+
+    /**
+     * @brief Get role names
+     *
+     * @return QHash<int, QByteArray>
+     */
+    QHash<int, QByteArray> roleNames() const override { return _roleNames; }
+
+    /**
+     * @brief Return the number of rows
+     *
+     * @param parent
+     * @return int
+     */
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override
+    {
+        Q_UNUSED(parent)
+        return _entries.size();
+    }
+
+signals:
+    void scanningChanged();
+
+private:
+    Q_DISABLE_COPY(LogCatalog)
+
+    /**
+     * @brief Load the cache file
+     *
+     */
+    void loadCache();
+
+    /**
+     * @brief Save the entries that were read in the cache file
+     *
+     */
+    void saveCache() const;
+
+    /**
+     * @brief Replace an entry with the information read in the background
+     *
+     * @param entry
+     */
+    void updateEntry(const Entry& entry);
+
+    /**
+     * @brief Called when all logs were read
+     *
+     */
+    void scanFinished();
+
+    // Cache file layout version, it should be increased for each change in Entry
+    static constexpr quint32 _cacheVersion = 1;
+    static const QByteArray _cacheMagic;
+
+    bool _cacheLoaded;
+    QString _cacheFileName;
+    QVector<Entry> _entries;
+    // Row of each log path
+    QHash<QString, int> _rows;
+    // Used by the background threads, it can't change while they run
+    QVector<QFileInfo> _pending;
+    // Files received while the logs are read, they are used when the reading finishes
+    QFileInfoList _nextFiles;
+    bool _nextFilesPending;
+    QFuture<void> _scan;
+    QFutureWatcher<void> _scanWatcher;
+
+    const QHash<int, QByteArray> _roleNames {
+        {FileName, "fileName"},
+        {FilePath, "filePath"},
+        {Ready, "ready"},
+        {Valid, "valid"},
+        {SensorName, "sensorName"},
+        {Firmware, "firmware"},
+        {StartTime, "startTime"},
+        {EndTime, "endTime"},
+        {Duration, "duration"},
+        {Packets, "packets"},
+        {Thumbnail, "thumbnail"},
+    };
+};
+
+/**
+ * @brief Provide the log thumbnails to QML images, E.g: "image://logcatalog/<encoded log path>"
+ *
+ */
+class LogCatalogImageProvider : public QQuickImageProvider {
+public:
+    /**
+     * @brief Construct a new Log Catalog Image Provider object
+     *
+     * @param catalog
+     */
+    LogCatalogImageProvider(const LogCatalog* catalog);
+
+    /**
+     * @brief Return the thumbnail of a log, it's called from the GUI thread since the images are synchronous
+     *
+     * @param id percent encoded log path
+     * @param size
+     * @param requestedSize
+     * @return QImage
+     */
+    QImage requestImage(const QString& id, QSize* size, const QSize& requestedSize) override;
+
+private:
+    const LogCatalog* _catalog;
+};
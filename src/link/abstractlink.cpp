@@ -11,10 +11,13 @@ AbstractLink::AbstractLink(const QString& name, QObject* parent)
     , _name(name)
     , _type(LinkType::None)
 {
-    connect(this, &AbstractLink::newData, this,
-        [&](const QByteArray& data) { _bitRateDownSpeed.numberOfBytes += data.size(); });
-    connect(this, &AbstractLink::sendData, this,
-        [&](const QByteArray& data) { _bitRateUpSpeed.numberOfBytes += data.size(); });
+    // Counted by the thread of the data, that can be the io thread
+    connect(
+        this, &AbstractLink::newData, this,
+        [&](const QByteArray& data) { _bitRateDownSpeed.numberOfBytes += data.size(); }, Qt::DirectConnection);
+    connect(
+        this, &AbstractLink::sendData, this,
+        [&](const QByteArray& data) { _bitRateUpSpeed.numberOfBytes += data.size(); }, Qt::DirectConnection);
     connect(&_oneSecondTimer, &QTimer::timeout, this, [&]() {
         _bitRateDownSpeed.update();
         _bitRateUpSpeed.update();
@@ -1,6 +1,10 @@
 #pragma once
 
+#include <atomic>
+#include <type_traits>
+
 #include <QObject>
+#include <QThread>
 #include <QTime>
 #include <QTimer>
 
@@ -35,6 +39,30 @@ public:
      */
     Q_INVOKABLE virtual qint64 byteSize() { return 0; };
 
+    /**
+     * @brief Call a function in the thread that receives and sends the link data, and wait for it to return
+     *  It's a direct call when used by that thread, or when the thread is not running.
+     *  When it returns, the data received before the call was already emitted by newData.
+     *
+     * @param function
+     * @return the function result
+     */
+    template <typename Function> auto callInIoThread(Function function) -> decltype(function())
+    {
+        QThread* ioThread = _ioContext.thread();
+        if (ioThread == QThread::currentThread() || !ioThread->isRunning()) {
+            return function();
+        }
+
+        if constexpr (std::is_void_v<decltype(function())>) {
+            QMetaObject::invokeMethod(&_ioContext, function, Qt::BlockingQueuedConnection);
+        } else {
+            decltype(function()) result {};
+            QMetaObject::invokeMethod(&_ioContext, function, Qt::BlockingQueuedConnection, &result);
+            return result;
+        }
+    }
+
     /**
      * @brief Return the link configuration pointer
      *
@@ -56,6 +84,13 @@ public:
      */
     Q_INVOKABLE virtual QString elapsedTimeString() { return elapsedTime().toString(_timeFormat); };
 
+    /**
+     * @brief Return the format of the time strings, it's also used by the packet timestamps of version 1 logs
+     *
+     * @return QString
+     */
+    static QString timeFormat() { return _timeFormat; }
+
     /**
      * @brief Return error in a human friendly message
      *
@@ -100,6 +135,20 @@ public:
      */
     Q_INVOKABLE virtual QStringList listAvailableConnections() { return QStringList(); };
 
+    /**
+     * @brief Move the reception and transmission of data to a thread, it should be done before startConnection
+     *  The link stays in its thread with its properties, only the objects used to receive and send data are moved.
+     *  newData is emitted by the new thread, and sendData is handled by it.
+     *  The move is done by the io thread, so it can be called by any thread. The objects should be moved back to the
+     *  thread of the link after finishConnection, before the link is destroyed.
+     *
+     * @param thread
+     */
+    void moveIoToThread(QThread* thread)
+    {
+        callInIoThread([this, thread] { _ioContext.moveToThread(thread); });
+    }
+
     /**
      * @brief Return the package size
      *
@@ -285,6 +334,8 @@ signals:
 
 protected:
     static const QString _timeFormat;
+    // Parent of the objects that receive and send data, they are moved with it by moveIoToThread
+    QObject _ioContext;
     LinkConfiguration _linkConfiguration;
 
 private:
@@ -293,10 +344,10 @@ private:
     QTimer _oneSecondTimer;
     LinkType _type;
 
-    // Up and down speed logic
+    // Up and down speed logic, the number of bytes is updated by the thread that receives or sends the data
     struct BitRateSpeed {
-        float speed;
-        float numberOfBytes;
+        float speed = 0;
+        std::atomic<int> numberOfBytes {0};
 
         /**
          * @brief Reset total number of bytes and set the current speed
@@ -304,8 +355,7 @@ private:
          */
         void update()
         {
-            speed = numberOfBytes;
-            numberOfBytes = 0;
+            speed = numberOfBytes.exchange(0);
         }
     } _bitRateUpSpeed, _bitRateDownSpeed;
 };
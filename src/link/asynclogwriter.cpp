@@ -0,0 +1,122 @@
+#include <algorithm>
+
+#include "asynclogwriter.h"
+#include "logger.h"
+
+PING_LOGGING_CATEGORY(PING_ASYNCLOGWRITER, "ping.asynclogwriter");
+
+AsyncLogWriter::AsyncLogWriter()
+    : _open(false)
+    , _queue(queueCapacity)
+    , _stop(false)
+{
+    _clock.start();
+}
+
+bool AsyncLogWriter::open(const QString& fileName, const LogSensorStruct& logSensorStruct, bool compress)
+{
+    close();
+    if (!_writer.open(fileName, logSensorStruct, compress)) {
+        return false;
+    }
+
+    // Packets queued after the last close are not part of the new log
+    Packet packet;
+    while (_queue.pop(packet)) {
+        qCDebug(PING_ASYNCLOGWRITER) << "Packet queued after the log was closed is discarded.";
+    }
+
+    _statistics.maxQueueDepth = 0;
+    _statistics.written = 0;
+    _statistics.dropped = 0;
+    _statistics.late = 0;
+
+    _stop = false;
+    _thread.reset(QThread::create([this] { run(); }));
+    _thread->setObjectName(QStringLiteral("AsyncLogWriter"));
+    _thread->start();
+    _open = true;
+    return true;
+}
+
+bool AsyncLogWriter::write(const QByteArray& data, quint64 timestampUs)
+{
+    if (!isOpen()) {
+        return false;
+    }
+
+    if (!_queue.push({data, timestampUs, _clock.elapsed()})) {
+        // Avoid a warning for each packet when the disk can't keep up
+        if (_statistics.dropped++ % 100 == 0) {
+            qCWarning(PING_ASYNCLOGWRITER) << "Log queue is full, packets dropped:" << _statistics.dropped;
+        }
+        return false;
+    }
+
+    const int depth = _queue.size();
+    _statistics.queueDepth = depth;
+    if (depth > _statistics.maxQueueDepth) {
+        _statistics.maxQueueDepth = depth;
+    }
+    return true;
+}
+
+int AsyncLogWriter::writeQueued()
+{
+    int count = 0;
+    Packet packet;
+    while (_queue.pop(packet)) {
+        _writer.write(packet.data, packet.timestampUs);
+        if (_clock.elapsed() - packet.queuedMs > lateThresholdMs) {
+            _statistics.late++;
+        }
+        count++;
+    }
+
+    if (count) {
+        // A single write call for the entire batch
+        _writer.flush();
+        _statistics.written += count;
+        _statistics.queueDepth = _queue.size();
+    }
+    return count;
+}
+
+void AsyncLogWriter::run()
+{
+    QElapsedTimer syncTimer;
+    syncTimer.start();
+    bool pendingSync = false;
+
+    while (!_stop) {
+        pendingSync |= writeQueued() > 0;
+        if (pendingSync && syncTimer.elapsed() >= syncIntervalMs) {
+            _writer.sync();
+            syncTimer.restart();
+            pendingSync = false;
+        }
+        QThread::msleep(pollIntervalMs);
+    }
+
+    // Packets queued before close should be in the log
+    writeQueued();
+}
+
+void AsyncLogWriter::close()
+{
+    if (!_thread) {
+        return;
+    }
+
+    _open = false;
+    _stop = true;
+    _thread->wait();
+    _thread.reset();
+    _writer.close();
+
+    qCDebug(PING_ASYNCLOGWRITER) << "Log closed, packets written:" << _statistics.written
+                                 << "dropped:" << _statistics.dropped << "late:" << _statistics.late
+                                 << "max queue depth:" << _statistics.maxQueueDepth;
+}
+
+AsyncLogWriter::~AsyncLogWriter() { close(); }
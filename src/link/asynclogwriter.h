@@ -0,0 +1,144 @@
+#pragma once
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QLoggingCategory>
+#include <QThread>
+
+#include <atomic>
+#include <memory>
+
+#include "logwriter.h"
+#include "spscqueue.h"
+
+Q_DECLARE_LOGGING_CATEGORY(PING_ASYNCLOGWRITER)
+
+/**
+ * @brief Write sensor logs in a dedicated thread
+ *  Packets are added to a bounded lock-free queue and written in batches by the writer thread, the caller never
+ *  waits for the disk. Packets are dropped if the queue is full.
+ *  The queue supports a single producer, write should always be called from the same thread.
+ *  open and close should never run at the same time, open can be called by the producer before its first write and
+ *  close by the owner after the producer is stopped.
+ *
+ */
+class AsyncLogWriter {
+public:
+    /**
+     * @brief Writer counters, can be read from any thread
+     *
+     */
+    struct Statistics {
+        // Number of packets waiting to be written
+        std::atomic<int> queueDepth {0};
+        std::atomic<int> maxQueueDepth {0};
+        std::atomic<quint64> written {0};
+        // Packets lost because the queue was full
+        std::atomic<quint64> dropped {0};
+        // Packets written more than lateThresholdMs after being queued
+        std::atomic<quint64> late {0};
+    };
+
+    /**
+     * @brief Construct a new Async Log Writer object
+     *
+     */
+    AsyncLogWriter();
+
+    /**
+     * @brief Destroy the Async Log Writer object, pending packets are written and the log is closed
+     *
+     */
+    ~AsyncLogWriter();
+
+    /**
+     * @brief Create the log file and start the writer thread
+     *  Should not be called at the same time as close
+     *
+     * @param fileName
+     * @param logSensorStruct
+     * @param compress packets will be saved in compressed blocks
+     * @return true
+     * @return false
+     */
+    bool open(const QString& fileName, const LogSensorStruct& logSensorStruct, bool compress);
+
+    /**
+     * @brief Check if the log file is open, can be called from any thread
+     *
+     * @return true
+     * @return false
+     */
+    bool isOpen() const { return _open; }
+
+    /**
+     * @brief Queue a packet to be written
+     *
+     * @param data
+     * @param timestampUs monotonic timestamp in microseconds since the start of the log
+     * @return false if the packet was dropped
+     */
+    bool write(const QByteArray& data, quint64 timestampUs);
+
+    /**
+     * @brief Write the pending packets, stop the writer thread and close the log
+     *  Should not be called at the same time as open, packets queued by the producer after it are not written
+     *
+     */
+    void close();
+
+    /**
+     * @brief Return a human friendly error message
+     *
+     * @return QString
+     */
+    QString errorString() const { return _writer.errorString(); }
+
+    /**
+     * @brief Return the writer counters
+     *
+     * @return const Statistics&
+     */
+    const Statistics& statistics() const { return _statistics; }
+
+    // Time between writer thread wake ups to check for new packets
+    static constexpr int pollIntervalMs = 20;
+    // Time between fsync calls, limits the data lost in a power failure
+    static constexpr int syncIntervalMs = 1000;
+    static constexpr int lateThresholdMs = 500;
+    static constexpr int queueCapacity = 4096;
+
+private:
+    Q_DISABLE_COPY(AsyncLogWriter)
+
+    struct Packet {
+        QByteArray data;
+        quint64 timestampUs;
+        // Monotonic time when the packet was queued
+        qint64 queuedMs;
+    };
+
+    /**
+     * @brief Writer thread loop
+     *
+     */
+    void run();
+
+    /**
+     * @brief Write all queued packets
+     *
+     * @return int number of packets written
+     */
+    int writeQueued();
+
+    QElapsedTimer _clock;
+    // Changed by open and close, read by the producer
+    std::atomic<bool> _open;
+    SpscQueue<Packet> _queue;
+    Statistics _statistics;
+    std::atomic<bool> _stop;
+    // Only accessed by open and close
+    std::unique_ptr<QThread> _thread;
+    // Only accessed by the writer thread while it's running
+    LogWriter _writer;
+};
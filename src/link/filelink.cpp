@@ -20,28 +20,27 @@ FileLink::FileLink(QObject* parent)
 {
     _timer.start();
     setType(LinkType::File);
-    connect(this, &AbstractLink::sendData, this, &FileLink::writeData);
+    // Logs are written by the thread that receives the data, that can be the io thread of the sensor link
+    connect(this, &AbstractLink::sendData, this, &FileLink::writeData, Qt::DirectConnection);
 }
 
 void FileLink::writeData(const QByteArray& data)
 {
     // Check if we have already opened the file
-    if (!_file.isOpen()) {
+    if (!_logWriter.isOpen()) {
         qCDebug(PING_PROTOCOL_FILELINK) << "File will be opened.";
-        if (!_file.open(QIODevice::ReadWrite)) {
+        if (!_logWriter.open(_file.fileName(), _logSensorStruct, _compressLog)) {
             qCDebug(PING_PROTOCOL_FILELINK) << "File was not open.";
             return;
         }
 
-        // Create log header
-        _inout << _logSensorStruct;
+        // Record timestamps start with the log
+        _timer.restart();
     }
 
-    // This save the data as a structure to deal with the timestamp
+    // This save the data as a record to deal with the timestamp, the file is written by the log writer thread
     if (_openModeFlag == QIODevice::WriteOnly && isWritable()) {
-        QString time = QTime::fromMSecsSinceStartOfDay(_timer.elapsed()).toString(_timeFormat);
-        Pack pack {time, data};
-        _inout << pack.time << pack.data;
+        _logWriter.write(data, _timer.nsecsElapsed() / 1000);
     } else {
         qCWarning(PING_PROTOCOL_FILELINK) << "Something is wrong!";
         qCDebug(PING_PROTOCOL_FILELINK) << "File is opened as write only:" << (_openModeFlag == QIODevice::WriteOnly);
@@ -97,6 +96,8 @@ bool FileLink::setConfiguration(const LinkConfiguration& linkConfiguration)
 bool FileLink::startConnection()
 {
     if (_openModeFlag == QIODevice::WriteOnly) {
+        // The settings are read by the owner thread, the file is only created with the first data by the link thread
+        _compressLog = SettingsManager::self()->compressSensorLog();
         return isWritable();
     }
 
@@ -108,20 +109,30 @@ bool FileLink::startConnection()
     _processLog->moveToThread(&_processLogThread);
 
     auto updateProcessReplayTime = [this]() {
-        int replayTimeMs = SettingsManager::self()->realTimeReplay() ? 0 : 100;
-        qCDebug(PING_PROTOCOL_FILELINK) << "Update replay time:" << replayTimeMs;
-        _processLog.get()->setReplayTimeMs(replayTimeMs);
+        int maximumIntervalMs = SettingsManager::self()->realTimeReplay() ? 0 : 100;
+        const double speed = SettingsManager::self()->replaySpeed();
+        qCDebug(PING_PROTOCOL_FILELINK) << "Update replay maximum interval:" << maximumIntervalMs << "speed:" << speed;
+        _processLog.get()->setMaximumIntervalMs(maximumIntervalMs);
+        _processLog.get()->setReplaySpeed(speed);
     };
 
     updateProcessReplayTime();
 
     connect(&_processLogThread, &QThread::started, _processLog.get(), &ProcessLog::run);
     connect(&_processLogThread, &QThread::finished, _processLog.get(), &ProcessLog::stop);
-    connect(_processLog.get(), &ProcessLog::newPackage, this, &FileLink::newData);
+    connect(_processLog.get(), &ProcessLog::newPackage, this, [this](const QByteArray& data) {
+        emit newData(data);
+        _processLog->packageProcessed();
+    });
+    connect(_processLog.get(), &ProcessLog::endOfLog, this, &FileLink::endOfLog);
     connect(_processLog.get(), &ProcessLog::packageIndexChanged, this, &FileLink::packageIndexChanged);
     connect(_processLog.get(), &ProcessLog::packageIndexChanged, this, &FileLink::elapsedTimeChanged);
+    connect(_processLog.get(), &ProcessLog::packageSizeChanged, this, &FileLink::packageSizeChanged);
+    connect(_processLog.get(), &ProcessLog::packageSizeChanged, this, &FileLink::totalTimeChanged);
     connect(SettingsManager::self(), &SettingsManager::realTimeReplayChanged, this,
         [updateProcessReplayTime] { updateProcessReplayTime(); });
+    connect(SettingsManager::self(), &SettingsManager::replaySpeedChanged, this,
+        [updateProcessReplayTime] { updateProcessReplayTime(); });
 
     processFile();
     return true;
@@ -129,21 +140,8 @@ bool FileLink::startConnection()
 
 void FileLink::processFile()
 {
-    Pack pack;
-
-    while (!_inout.atEnd()) {
-        // Get data
-        _inout >> pack.time >> pack.data;
-
-        // Check if we have a new package
-        if (pack.time.isEmpty()) {
-            qCDebug(PING_PROTOCOL_FILELINK) << "No more packages !";
-            break;
-        }
-
-        auto time = QTime::fromString(pack.time, _timeFormat);
-        _processLog->append(time, pack.data);
-    }
+    // The packets are indexed and read on demand by the process log, starting after the log header
+    _processLog->setLogFile(_file.fileName(), _file.pos(), _logSensorStruct.version, _timeFormat);
     _processLogThread.start();
     emit elapsedTimeChanged();
     emit totalTimeChanged();
@@ -208,6 +206,7 @@ bool FileLink::finishConnection()
     if (_file.isOpen()) {
         _file.close();
     }
+    _logWriter.close();
     return true;
 }
 
@@ -9,6 +9,7 @@
 #include <memory>
 
 #include "abstractlink.h"
+#include "asynclogwriter.h"
 #include "logsensorstruct.h"
 #include "processlog.h"
 
@@ -46,7 +47,10 @@ public:
      *
      * @return QString
      */
-    QString errorString() final { return _file.errorString(); };
+    QString errorString() final
+    {
+        return _openModeFlag == QIODevice::WriteOnly ? _logWriter.errorString() : _file.errorString();
+    };
 
     /**
      * @brief Closes connection
@@ -105,6 +109,17 @@ public:
      */
     bool setConfiguration(const LinkConfiguration& linkConfiguration) final;
 
+    /**
+     * @brief Set the replay speed of the log, it overrides the replay speed setting until it changes
+     *
+     * @param speed multiplier of the log time, ReplayScheduler::asFastAsPossible to play without waiting
+     */
+    void setReplaySpeed(double speed)
+    {
+        if (_processLog)
+            _processLog->setReplaySpeed(speed);
+    }
+
     /**
      * @brief Set the package index
      *
@@ -156,17 +171,35 @@ public:
      */
     static LogSensorStruct staticLogSensorStruct(const LinkConfiguration& linkConfiguration);
 
-private:
-    struct Pack {
-        QString time;
-        QByteArray data;
-    };
+    /**
+     * @brief Return the log writer counters (queue depth, dropped and late packets)
+     *
+     * @return const AsyncLogWriter::Statistics&
+     */
+    const AsyncLogWriter::Statistics& logWriterStatistics() const { return _logWriter.statistics(); }
 
+    /**
+     * @brief Return the replay pacing drift, nullptr if the log is not being played
+     *
+     * @return const ReplayScheduler::Statistics*
+     */
+    const ReplayScheduler::Statistics* replayStatistics() const
+    {
+        return _processLog ? &_processLog->replayStatistics() : nullptr;
+    }
+
+signals:
+    void endOfLog();
+
+private:
+    // Compression of a new log, set by startConnection before the data is written
+    bool _compressLog = false;
     QIODevice::OpenModeFlag _openModeFlag;
     QElapsedTimer _timer;
 
     QFile _file;
     QDataStream _inout;
+    AsyncLogWriter _logWriter;
 
     LogSensorStruct _logSensorStruct;
 
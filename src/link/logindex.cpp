@@ -0,0 +1,165 @@
+#include <algorithm>
+#include <cstring>
+
+#include <QDateTime>
+#include <QFileInfo>
+#include <QtEndian>
+
+#include "logger.h"
+#include "logindex.h"
+#include "ping-message-all.h"
+
+PING_LOGGING_CATEGORY(PING_LOGINDEX, "ping.logindex");
+
+const QByteArray LogIndex::_magic = QByteArrayLiteral("PVLOGIDX");
+
+LogIndex::LogIndex()
+    : _mappedEntries(nullptr)
+    , _mappedSize(0)
+{
+}
+
+void LogIndex::append(const QVector<Entry>& entries)
+{
+    Q_ASSERT(!_mappedEntries);
+    _entries.append(entries);
+}
+
+LogIndex::Entry LogIndex::at(int index) const
+{
+    if (!_mappedEntries) {
+        return _entries[index];
+    }
+
+    const uchar* data = _mappedEntries + index * _entrySize;
+    return {
+        qFromLittleEndian<qint64>(data),
+        qFromLittleEndian<qint64>(data + 8),
+        qFromLittleEndian<quint32>(data + 16),
+        qFromLittleEndian<qint32>(data + 20),
+        qFromLittleEndian<quint16>(data + 24),
+        qFromLittleEndian<quint16>(data + 26),
+    };
+}
+
+void LogIndex::clear()
+{
+    _entries.clear();
+    _mappedEntries = nullptr;
+    _mappedSize = 0;
+    _sidecar.close();
+}
+
+bool LogIndex::load(const QString& logFileName)
+{
+    clear();
+
+    _sidecar.setFileName(sidecarFileName(logFileName));
+    if (!_sidecar.exists() || !_sidecar.open(QIODevice::ReadOnly)) {
+        qCDebug(PING_LOGINDEX) << "No sidecar index for:" << logFileName;
+        return false;
+    }
+
+    const uchar* map = _sidecar.map(0, _sidecar.size());
+    if (!map || _sidecar.size() < _headerSize) {
+        qCDebug(PING_LOGINDEX) << "Invalid sidecar index file:" << _sidecar.fileName();
+        clear();
+        return false;
+    }
+
+    const QFileInfo logInfo(logFileName);
+    const bool validHeader = QByteArray::fromRawData(reinterpret_cast<const char*>(map), _magic.size()) == _magic
+        && qFromLittleEndian<quint32>(map + 8) == _version && qFromLittleEndian<quint32>(map + 12) == _entrySize
+        && qFromLittleEndian<qint64>(map + 16) == logInfo.size()
+        && qFromLittleEndian<qint64>(map + 24) == logInfo.lastModified().toMSecsSinceEpoch();
+    const quint32 count = qFromLittleEndian<quint32>(map + 32);
+    if (!validHeader || _headerSize + static_cast<qint64>(count) * _entrySize != _sidecar.size()) {
+        qCDebug(PING_LOGINDEX) << "Sidecar index does not match the log file:" << _sidecar.fileName();
+        clear();
+        return false;
+    }
+
+    _mappedEntries = map + _headerSize;
+    _mappedSize = count;
+    qCDebug(PING_LOGINDEX) << "Sidecar index loaded with" << _mappedSize << "packets:" << _sidecar.fileName();
+    return true;
+}
+
+void LogIndex::describePacket(const QByteArray& data, Entry& entry)
+{
+    entry.messageId = 0;
+    entry.angle = noAngle;
+
+    // Ping messages start with 'BR', followed by payload length and message id
+    if (data.size() < ping_message::headerLength || data[0] != 'B' || data[1] != 'R') {
+        return;
+    }
+    const auto bytes = reinterpret_cast<const uchar*>(data.constData());
+    entry.messageId = qFromLittleEndian<quint16>(bytes + 4);
+
+    // Ping360 data messages start with mode and gain setting (uint8), followed by the angle (uint16)
+    if ((entry.messageId == Ping360Id::DEVICE_DATA || entry.messageId == Ping360Id::AUTO_DEVICE_DATA)
+        && data.size() >= ping_message::headerLength + 4) {
+        entry.angle = qFromLittleEndian<quint16>(bytes + ping_message::headerLength + 2);
+    }
+}
+
+bool LogIndexWriter::open(const QString& logFileName)
+{
+    _logFileName = logFileName;
+    _count = 0;
+    _sidecar.setFileName(LogIndex::sidecarFileName(logFileName));
+    if (!_sidecar.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qCWarning(PING_LOGINDEX) << "Failed to create sidecar index:" << _sidecar.fileName() << _sidecar.errorString();
+        return false;
+    }
+
+    // The header is not valid until the log is finished
+    writeHeader(0, 0);
+    return true;
+}
+
+void LogIndexWriter::append(const LogIndex::Entry& entry)
+{
+    if (!_sidecar.isOpen()) {
+        return;
+    }
+
+    uchar data[LogIndex::_entrySize];
+    qToLittleEndian<qint64>(entry.offset, data);
+    qToLittleEndian<qint64>(entry.timestampUs, data + 8);
+    qToLittleEndian<quint32>(entry.length, data + 16);
+    qToLittleEndian<qint32>(entry.blockOffset, data + 20);
+    qToLittleEndian<quint16>(entry.messageId, data + 24);
+    qToLittleEndian<quint16>(entry.angle, data + 26);
+    _sidecar.write(reinterpret_cast<const char*>(data), sizeof(data));
+    _count++;
+}
+
+void LogIndexWriter::finish()
+{
+    if (!_sidecar.isOpen()) {
+        return;
+    }
+
+    const QFileInfo logInfo(_logFileName);
+    writeHeader(logInfo.size(), logInfo.lastModified().toMSecsSinceEpoch());
+    _sidecar.close();
+    qCDebug(PING_LOGINDEX) << "Sidecar index written with" << _count << "packets:" << _sidecar.fileName();
+}
+
+void LogIndexWriter::writeHeader(qint64 logSize, qint64 logModifiedMs)
+{
+    uchar header[LogIndex::_headerSize] = {};
+    memcpy(header, LogIndex::_magic.constData(), LogIndex::_magic.size());
+    qToLittleEndian<quint32>(LogIndex::_version, header + 8);
+    qToLittleEndian<quint32>(LogIndex::_entrySize, header + 12);
+    qToLittleEndian<qint64>(logSize, header + 16);
+    qToLittleEndian<qint64>(logModifiedMs, header + 24);
+    qToLittleEndian<quint32>(_count, header + 32);
+
+    const qint64 position = _sidecar.pos();
+    _sidecar.seek(0);
+    _sidecar.write(reinterpret_cast<const char*>(header), sizeof(header));
+    _sidecar.seek(std::max(position, static_cast<qint64>(sizeof(header))));
+}
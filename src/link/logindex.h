@@ -0,0 +1,170 @@
+#pragma once
+
+#include <QByteArray>
+#include <QFile>
+#include <QLoggingCategory>
+#include <QString>
+#include <QVector>
+
+Q_DECLARE_LOGGING_CATEGORY(PING_LOGINDEX)
+
+/**
+ * @brief Index of the packets in a sensor log file
+ *  The index can be built in memory while the log is read, or loaded from the sidecar index file written with the
+ *  log (<log file name>.idx). The sidecar file is memory mapped, loading it does not depend of the log size.
+ *
+ *  Sidecar file layout, all values in little endian:
+ *      Header: magic (8 bytes), version (uint32), entry size (uint32), log size (int64),
+ *          log modification time in ms since epoch (int64), number of entries (uint32), reserved (uint32)
+ *      Entries: offset (int64), timestamp in microseconds (int64), length (uint32), block offset (int32),
+ *          message id (uint16), angle (uint16)
+ */
+class LogIndex {
+public:
+    /**
+     * @brief Information of a single log packet
+     *
+     */
+    struct Entry {
+        // Position of the packet data in the log file, or of the compressed block data that contains the packet
+        qint64 offset;
+        // Packet timestamp in microseconds, it's monotonic for the entire log
+        qint64 timestampUs;
+        quint32 length;
+        // Position of the packet data in the uncompressed block, noBlock if the packet is not compressed
+        qint32 blockOffset;
+        // Message id of the first ping message in the packet, 0 if the packet does not start with a message
+        quint16 messageId;
+        // Ping360 angle in gradians of the first message in the packet, noAngle if not available
+        quint16 angle;
+    };
+
+    static constexpr quint16 noAngle = 0xFFFF;
+    static constexpr qint32 noBlock = -1;
+
+    /**
+     * @brief Construct a new empty Log Index object
+     *
+     */
+    LogIndex();
+
+    /**
+     * @brief Append entries to the in memory index
+     *
+     * @param entries
+     */
+    void append(const QVector<Entry>& entries);
+
+    /**
+     * @brief Return the entry of a packet
+     *
+     * @param index
+     * @return Entry
+     */
+    Entry at(int index) const;
+
+    /**
+     * @brief Remove all entries and release the sidecar file
+     *
+     */
+    void clear();
+
+    /**
+     * @brief Return true if the index has no entries
+     *
+     * @return true
+     * @return false
+     */
+    bool isEmpty() const { return size() == 0; }
+
+    /**
+     * @brief Load the sidecar index of a log file
+     *  The sidecar is only used if it matches the actual size and modification time of the log file
+     *
+     * @param logFileName
+     * @return true if the index was loaded
+     * @return false
+     */
+    bool load(const QString& logFileName);
+
+    /**
+     * @brief Return the number of entries
+     *
+     * @return int
+     */
+    int size() const { return _mappedEntries ? _mappedSize : _entries.size(); }
+
+    /**
+     * @brief Fill message id and angle of an entry from the packet data
+     *  Only packets that start with a ping message are described, it's a best effort since links can split messages
+     *
+     * @param data
+     * @param entry
+     */
+    static void describePacket(const QByteArray& data, Entry& entry);
+
+    /**
+     * @brief Return the sidecar index file name of a log file
+     *
+     * @param logFileName
+     * @return QString
+     */
+    static QString sidecarFileName(const QString& logFileName) { return logFileName + QStringLiteral(".idx"); }
+
+private:
+    friend class LogIndexWriter;
+
+    static const QByteArray _magic;
+    static constexpr quint32 _version = 3;
+    static constexpr int _headerSize = 40;
+    static constexpr int _entrySize = 28;
+
+    QVector<Entry> _entries;
+    const uchar* _mappedEntries;
+    int _mappedSize;
+    QFile _sidecar;
+};
+
+/**
+ * @brief Write the sidecar index of a log file while the log is written
+ *  The header is only valid after finish, an interrupted log will have an invalid sidecar and will be indexed again
+ *
+ */
+class LogIndexWriter {
+public:
+    /**
+     * @brief Create the sidecar index file of a log file
+     *
+     * @param logFileName
+     * @return true
+     * @return false
+     */
+    bool open(const QString& logFileName);
+
+    /**
+     * @brief Append a packet entry
+     *
+     * @param entry
+     */
+    void append(const LogIndex::Entry& entry);
+
+    /**
+     * @brief Write the header with the final log file information and close the sidecar file
+     *  The log file should be closed before this call
+     *
+     */
+    void finish();
+
+private:
+    /**
+     * @brief Write the sidecar header
+     *
+     * @param logSize
+     * @param logModifiedMs
+     */
+    void writeHeader(qint64 logSize, qint64 logModifiedMs);
+
+    quint32 _count = 0;
+    QString _logFileName;
+    QFile _sidecar;
+};
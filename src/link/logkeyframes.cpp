@@ -0,0 +1,55 @@
+#include <algorithm>
+
+#include "logkeyframes.h"
+
+LogKeyframes::LogKeyframes() { clear(); }
+
+void LogKeyframes::clear()
+{
+    _keyframes.clear();
+    _latest.fill(-1, numberOfAngles);
+    _size = 0;
+}
+
+void LogKeyframes::update(const LogIndex& index, int count)
+{
+    count = std::min(count, index.size());
+    for (; _size < count; _size++) {
+        if (_size % interval == 0) {
+            _keyframes.append(_latest);
+        }
+
+        const quint16 angle = index.at(_size).angle;
+        if (angle < numberOfAngles) {
+            _latest[angle] = _size;
+        }
+    }
+}
+
+QVector<int> LogKeyframes::latestPackets(const LogIndex& index, int packetIndex) const
+{
+    QVector<int> packets;
+    if (_keyframes.isEmpty() || packetIndex <= 0) {
+        return packets;
+    }
+
+    // Apply the angles of the packets after the keyframe
+    packetIndex = std::min(packetIndex, _size);
+    const int keyframe = std::min(packetIndex / interval, _keyframes.size() / numberOfAngles - 1);
+    QVector<qint32> latest = _keyframes.mid(keyframe * numberOfAngles, numberOfAngles);
+    for (int packet = keyframe * interval; packet < packetIndex; packet++) {
+        const quint16 angle = index.at(packet).angle;
+        if (angle < numberOfAngles) {
+            latest[angle] = packet;
+        }
+    }
+
+    packets.reserve(numberOfAngles);
+    for (const qint32 packet : qAsConst(latest)) {
+        if (packet >= 0) {
+            packets.append(packet);
+        }
+    }
+    std::sort(packets.begin(), packets.end());
+    return packets;
+}
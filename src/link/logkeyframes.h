@@ -0,0 +1,63 @@
+#pragma once
+
+#include <QVector>
+
+#include "logindex.h"
+
+/**
+ * @brief Keyframes of a Ping360 log, used to restore the polar image after a seek
+ *  A keyframe is taken each interval packets, it has the index of the latest packet of each angle before it.
+ *  The state of any packet is the nearest previous keyframe updated with the angles of the packets after it,
+ *  only the log index is read. The packets are not copied, a keyframe uses 4 bytes per angle.
+ */
+class LogKeyframes {
+public:
+    // Packets between keyframes
+    static constexpr int interval = 1000;
+    // Ping360 angles in gradians
+    static constexpr int numberOfAngles = 400;
+
+    /**
+     * @brief Construct a new empty Log Keyframes object
+     *
+     */
+    LogKeyframes();
+
+    /**
+     * @brief Remove all keyframes
+     *
+     */
+    void clear();
+
+    /**
+     * @brief Add the packets of the index up to a number of packets
+     *
+     * @param index
+     * @param count number of packets of the index that should be processed
+     */
+    void update(const LogIndex& index, int count);
+
+    /**
+     * @brief Return the number of processed packets
+     *
+     * @return int
+     */
+    int size() const { return _size; }
+
+    /**
+     * @brief Return the latest packet of each angle before a packet, sorted by packet index
+     *  The packets should be processed with update before this call
+     *
+     * @param index
+     * @param packetIndex
+     * @return QVector<int>
+     */
+    QVector<int> latestPackets(const LogIndex& index, int packetIndex) const;
+
+private:
+    // Keyframe k has numberOfAngles packet indexes of packets [0, k * interval), -1 for angles without packets
+    QVector<qint32> _keyframes;
+    // Latest packet of each angle of the processed packets
+    QVector<qint32> _latest;
+    int _size;
+};
@@ -1,5 +1,6 @@
 #include <QDataStream>
 #include <QDebug>
+#include <QtEndian>
 
 #include "logsensorstruct.h"
 
@@ -55,3 +56,22 @@ QDebug operator<<(QDebug out, const LogSensorStruct& other)
     out << "Sensor family and type:" << other.sensor << "\n";
     return out;
 }
+
+void LogRecordHeader::serialize(uchar* data) const
+{
+    data[0] = type;
+    data[1] = flags;
+    qToLittleEndian<quint16>(0, data + 2);
+    qToLittleEndian<quint32>(length, data + 4);
+    qToLittleEndian<quint64>(timestampUs, data + 8);
+}
+
+LogRecordHeader LogRecordHeader::deserialize(const uchar* data)
+{
+    LogRecordHeader header;
+    header.type = data[0];
+    header.flags = data[1];
+    header.length = qFromLittleEndian<quint32>(data + 4);
+    header.timestampUs = qFromLittleEndian<quint64>(data + 8);
+    return header;
+}
@@ -80,10 +80,48 @@ struct LogSensorStruct {
         sensor = sensorInfo;
     }
 
-    uint _actualVersion = 1;
+    // Version 2 uses LogRecordHeader for each packet, version 1 uses a time string and a byte array
+    uint _actualVersion = 2;
     QString _validHeader = QStringLiteral("PingViewer sensor log file");
 };
 
+/**
+ * @brief Header of each packet record in version 2 logs
+ *  Records are saved after the log header as this fixed size header followed by the packet data.
+ *  Block records hold a sequence of packet records compressed with qCompress, the timestamp is the one of the
+ *  first packet. All values are little endian:
+ *      type (uint8), flags (uint8), reserved (uint16), data length (uint32),
+ *      timestamp in microseconds since the start of the log (uint64), it's monotonic and does not wrap
+ */
+struct LogRecordHeader {
+    enum Type : quint8 {
+        Packet = 0,
+        Block = 1,
+    };
+
+    quint8 type = Packet;
+    quint8 flags = 0;
+    quint32 length = 0;
+    quint64 timestampUs = 0;
+
+    static constexpr int size = 16;
+
+    /**
+     * @brief Write the header in a buffer with at least size bytes
+     *
+     * @param data
+     */
+    void serialize(uchar* data) const;
+
+    /**
+     * @brief Read a header from a buffer with at least size bytes
+     *
+     * @param data
+     * @return LogRecordHeader
+     */
+    static LogRecordHeader deserialize(const uchar* data);
+};
+
 /**
  * @brief Helper function for LogSensorStruct and QDataStream
  *
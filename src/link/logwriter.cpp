@@ -0,0 +1,155 @@
+#include <QBuffer>
+#include <QDataStream>
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "logger.h"
+#include "logwriter.h"
+
+PING_LOGGING_CATEGORY(PING_LOGWRITER, "ping.logwriter");
+
+LogWriter::LogWriter()
+    : _blockTimestampUs(0)
+    , _compress(false)
+    , _position(0)
+{
+}
+
+bool LogWriter::open(const QString& fileName, const LogSensorStruct& logSensorStruct, bool compress)
+{
+    // The records are buffered by the writer, there is no need for the QFile buffer
+    _file.setFileName(fileName);
+    if (!_file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Unbuffered)) {
+        qCWarning(PING_LOGWRITER) << "Failed to create log file:" << fileName << _file.errorString();
+        return false;
+    }
+
+    _compress = compress;
+    _block.clear();
+    _blockEntries.clear();
+    _output.clear();
+
+    QBuffer buffer(&_output);
+    buffer.open(QIODevice::WriteOnly);
+    QDataStream out(&buffer);
+    out << logSensorStruct;
+    _position = _output.size();
+    _indexWriter.open(fileName);
+
+    qCDebug(PING_LOGWRITER) << "Log file created:" << fileName << "compressed:" << _compress;
+    return true;
+}
+
+void LogWriter::appendRecord(const LogRecordHeader& header, const QByteArray& data)
+{
+    uchar headerData[LogRecordHeader::size];
+    header.serialize(headerData);
+    _output.append(reinterpret_cast<const char*>(headerData), sizeof(headerData));
+    _output.append(data);
+    _position += sizeof(headerData) + data.size();
+}
+
+void LogWriter::write(const QByteArray& data, quint64 timestampUs)
+{
+    if (!_file.isOpen()) {
+        return;
+    }
+
+    LogRecordHeader header;
+    header.length = data.size();
+    header.timestampUs = timestampUs;
+
+    if (!_compress) {
+        LogIndex::Entry entry {_position + LogRecordHeader::size, static_cast<qint64>(timestampUs), header.length,
+            LogIndex::noBlock, 0, LogIndex::noAngle};
+        LogIndex::describePacket(data, entry);
+        appendRecord(header, data);
+        _indexWriter.append(entry);
+        return;
+    }
+
+    // Packets are saved in the block with the same record format of uncompressed logs
+    if (_block.isEmpty()) {
+        _blockTimestampUs = timestampUs;
+    }
+    uchar headerData[LogRecordHeader::size];
+    header.serialize(headerData);
+    _block.append(reinterpret_cast<const char*>(headerData), sizeof(headerData));
+    LogIndex::Entry entry {0, static_cast<qint64>(timestampUs), header.length, _block.size(), 0, LogIndex::noAngle};
+    LogIndex::describePacket(data, entry);
+    _block.append(data);
+    _blockEntries.append(entry);
+
+    if (_block.size() >= _blockSize || timestampUs - _blockTimestampUs >= _blockMaxAgeUs) {
+        flushBlock();
+    }
+}
+
+void LogWriter::flushBlock()
+{
+    if (_block.isEmpty()) {
+        return;
+    }
+
+    LogRecordHeader header;
+    header.type = LogRecordHeader::Block;
+    header.timestampUs = _blockTimestampUs;
+    const QByteArray compressed = qCompress(_block, _compressionLevel);
+    header.length = compressed.size();
+
+    // All packets in the block point to the compressed block data
+    const qint64 blockPosition = _position + LogRecordHeader::size;
+    appendRecord(header, compressed);
+    for (auto& entry : _blockEntries) {
+        entry.offset = blockPosition;
+        _indexWriter.append(entry);
+    }
+
+    _block.clear();
+    _blockEntries.clear();
+}
+
+void LogWriter::flush()
+{
+    if (_output.isEmpty() || !_file.isOpen()) {
+        return;
+    }
+
+    if (_file.write(_output) != _output.size()) {
+        qCWarning(PING_LOGWRITER) << "Failed to write log file:" << _file.errorString();
+    }
+    _output.clear();
+}
+
+void LogWriter::sync()
+{
+    flush();
+    if (!_file.isOpen()) {
+        return;
+    }
+
+#ifdef Q_OS_WIN
+    _commit(_file.handle());
+#else
+    fsync(_file.handle());
+#endif
+}
+
+void LogWriter::close()
+{
+    if (!_file.isOpen()) {
+        return;
+    }
+
+    flushBlock();
+    flush();
+    _file.close();
+    // The sidecar index is valid only for the final log file
+    _indexWriter.finish();
+}
+
+LogWriter::~LogWriter() { close(); }
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <QByteArray>
+#include <QFile>
+#include <QLoggingCategory>
+#include <QVector>
+
+#include "logindex.h"
+#include "logsensorstruct.h"
+
+Q_DECLARE_LOGGING_CATEGORY(PING_LOGWRITER)
+
+/**
+ * @brief Write sensor logs with the version 2 format and the sidecar index
+ *  Packets can be grouped in compressed blocks, each block is compressed independently to allow the reader to
+ *  seek to any packet decompressing a single block.
+ *  Records are kept in memory until flush, allowing a single write call for multiple packets.
+ *
+ */
+class LogWriter {
+public:
+    /**
+     * @brief Construct a new Log Writer object
+     *
+     */
+    LogWriter();
+
+    /**
+     * @brief Destroy the Log Writer object, the log is closed if necessary
+     *
+     */
+    ~LogWriter();
+
+    /**
+     * @brief Create the log file and write the header
+     *
+     * @param fileName
+     * @param logSensorStruct
+     * @param compress packets will be saved in compressed blocks
+     * @return true
+     * @return false
+     */
+    bool open(const QString& fileName, const LogSensorStruct& logSensorStruct, bool compress);
+
+    /**
+     * @brief Check if the log file is open
+     *
+     * @return true
+     * @return false
+     */
+    bool isOpen() const { return _file.isOpen(); }
+
+    /**
+     * @brief Write a packet
+     *
+     * @param data
+     * @param timestampUs monotonic timestamp in microseconds since the start of the log
+     */
+    void write(const QByteArray& data, quint64 timestampUs);
+
+    /**
+     * @brief Write the buffered records to the file
+     *  Packets in a pending compressed block are only written when the block is complete
+     *
+     */
+    void flush();
+
+    /**
+     * @brief Flush and ask the operating system to write the file to the storage device
+     *
+     */
+    void sync();
+
+    /**
+     * @brief Write the pending block, close the log file and finish the sidecar index
+     *
+     */
+    void close();
+
+    /**
+     * @brief Return a human friendly error message
+     *
+     * @return QString
+     */
+    QString errorString() const { return _file.errorString(); }
+
+private:
+    Q_DISABLE_COPY(LogWriter)
+
+    /**
+     * @brief Compress and write the pending block
+     *
+     */
+    void flushBlock();
+
+    /**
+     * @brief Append a record to the output buffer
+     *
+     * @param header
+     * @param data
+     */
+    void appendRecord(const LogRecordHeader& header, const QByteArray& data);
+
+    QByteArray _block;
+    // Index entries of the packets in the pending block, the block position is only known when it's written
+    QVector<LogIndex::Entry> _blockEntries;
+    quint64 _blockTimestampUs;
+    bool _compress;
+    QFile _file;
+    LogIndexWriter _indexWriter;
+    // Records not written to the file yet
+    QByteArray _output;
+    // Position in the file after the buffered records
+    qint64 _position;
+
+    // Blocks are written when they are bigger than this size or older than _blockMaxAgeUs
+    static constexpr int _blockSize = 64 * 1024;
+    static constexpr quint64 _blockMaxAgeUs = 1000 * 1000;
+    // Sensor data has long runs of similar values, the fastest zlib level already provides most of the gain
+    static constexpr int _compressionLevel = 1;
+};
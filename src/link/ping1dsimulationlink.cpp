@@ -1,36 +1,49 @@
 #include <QtMath>
 
 #include "ping1dsimulationlink.h"
-#include <ping-message-ping1d.h>
+#include "pingchecksum.h"
+
+const float numPoints = 200;
+const float maxDepth = 120000;
 
 Ping1DSimulationLink::Ping1DSimulationLink(QObject* parent)
     : SimulationLink(parent)
+    , _counter(1)
+    , _profile(numPoints)
+    , _randomUpdateTimer(&_ioContext)
+{
+    // The profiles are generated by the io thread
+    connect(&_randomUpdateTimer, &QTimer::timeout, this, &Ping1DSimulationLink::randomUpdate, Qt::DirectConnection);
+}
+
+bool Ping1DSimulationLink::startConnection()
 {
-    connect(&_randomUpdateTimer, &QTimer::timeout, this, &Ping1DSimulationLink::randomUpdate);
-    _randomUpdateTimer.start(50);
+    callInIoThread([this] { _randomUpdateTimer.start(50); });
+    return true;
+}
+
+bool Ping1DSimulationLink::finishConnection()
+{
+    callInIoThread([this] { _randomUpdateTimer.stop(); });
+    return true;
 }
 
 void Ping1DSimulationLink::randomUpdate()
 {
-    static uint counter = 1;
-    static const float numPoints = 200;
-    static const float maxDepth = 120000;
-    const float stop1 = numPoints / 2.0 - 10 * qSin(counter / 10.0);
-    const float stop2 = 3 * numPoints / 5.0 + 6 * qCos(counter / 5.5);
-    const float osc = maxDepth * (1.3 + qCos(counter / 40.0)) / 2.3;
+    const float stop1 = numPoints / 2.0 - 10 * qSin(_counter / 10.0);
+    const float stop2 = 3 * numPoints / 5.0 + 6 * qCos(_counter / 5.5);
+    const float osc = maxDepth * (1.3 + qCos(_counter / 40.0)) / 2.3;
 
     uint8_t conf = 400 / (stop2 - stop1);
 
-    static ping1d_profile profile(numPoints);
-
-    profile.set_distance(osc * (stop2 + stop1) / (numPoints * 2));
-    profile.set_confidence(conf);
-    profile.set_transmit_duration(200);
-    profile.set_ping_number(counter);
-    profile.set_scan_start(0);
-    profile.set_scan_length(osc);
-    profile.set_gain_setting(4);
-    profile.set_profile_data_length(numPoints);
+    _profile.set_distance(osc * (stop2 + stop1) / (numPoints * 2));
+    _profile.set_confidence(conf);
+    _profile.set_transmit_duration(200);
+    _profile.set_ping_number(_counter);
+    _profile.set_scan_start(0);
+    _profile.set_scan_length(osc);
+    _profile.set_gain_setting(4);
+    _profile.set_profile_data_length(numPoints);
 
     for (int i = 0; i < numPoints; i++) {
         float point;
@@ -42,11 +55,11 @@ void Ping1DSimulationLink::randomUpdate()
         } else {
             point = 0.45 * randomPoint<uint8_t>();
         }
-        profile.set_profile_data_at(i, point);
+        _profile.set_profile_data_at(i, point);
     }
 
-    profile.updateChecksum();
-    emit newData(QByteArray(reinterpret_cast<const char*>(profile.msgData), profile.msgDataLength()));
+    PingChecksum::update(_profile);
+    emit newData(QByteArray(reinterpret_cast<const char*>(_profile.msgData), _profile.msgDataLength()));
 
-    counter++;
+    _counter++;
 }
@@ -3,6 +3,8 @@
 #include "simulationlink.h"
 #include <QTimer>
 
+#include <ping-message-ping1d.h>
+
 /**
  * @brief Link that simulates Ping sensor behaviour
  *
@@ -16,12 +18,28 @@ public:
      */
     Ping1DSimulationLink(QObject* parent = nullptr);
 
+    /**
+     * @brief Stop the profiles
+     *
+     * @return true
+     */
+    bool finishConnection() final;
+
     /**
      * @brief Generates random data
      *
      */
     void randomUpdate();
 
+    /**
+     * @brief Start the profiles
+     *
+     * @return true
+     */
+    bool startConnection() final;
+
 private:
+    uint _counter;
+    ping1d_profile _profile;
     QTimer _randomUpdateTimer;
 };
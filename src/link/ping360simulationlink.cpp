@@ -2,17 +2,24 @@
 #include <QElapsedTimer>
 #include <QtMath>
 
-#include "ping-message-ping360.h"
 #include "ping360simulationlink.h"
+#include "pingchecksum.h"
+
+const float numberOfSamples = 1200;
+const int angularResolution = 400;
 
 Ping360SimulationLink::Ping360SimulationLink(QObject* parent)
     : SimulationLink(parent)
     , _counter(0)
+    , _deviceData(numberOfSamples)
     , _globalAverageTimeMs(0)
     , _spins(0)
 {
     _elapsedTimer.start();
-    connect(this, &AbstractLink::sendData, this, &Ping360SimulationLink::handleData, Qt::QueuedConnection);
+    // The requests are handled and the profiles generated by the io thread
+    connect(
+        this, &AbstractLink::sendData, &_ioContext, [this](const QByteArray& data) { handleData(data); },
+        Qt::QueuedConnection);
 }
 
 void Ping360SimulationLink::handleData(const QByteArray& byteArray)
@@ -33,28 +40,24 @@ void Ping360SimulationLink::handleData(const QByteArray& byteArray)
         randomUpdate();
 #else
         // This goes near to 3s scan time or a sample rate of 133Hz per profile
-        QTimer::singleShot(7, [this] { randomUpdate(); });
+        QTimer::singleShot(7, &_ioContext, [this] { randomUpdate(); });
 #endif
     }
 }
 
 void Ping360SimulationLink::randomUpdate()
 {
-    static const float numberOfSamples = 1200;
-    static const int angularResolution = 400;
-
     const float stop1 = numberOfSamples / 2.0 - 10 * qSin(_counter / 10.0);
     const float stop2 = 3 * numberOfSamples / 5.0 + 6 * qCos(_counter / 5.5);
 
-    static ping360_device_data deviceData(numberOfSamples);
-    deviceData.set_mode(0);
-    deviceData.set_gain_setting(1);
-    deviceData.set_angle(_counter % angularResolution);
-    deviceData.set_transmit_duration(1000);
-    deviceData.set_sample_period(80);
-    deviceData.set_transmit_frequency(700);
-    deviceData.set_number_of_samples(numberOfSamples);
-    deviceData.set_data_length(numberOfSamples);
+    _deviceData.set_mode(0);
+    _deviceData.set_gain_setting(1);
+    _deviceData.set_angle(_counter % angularResolution);
+    _deviceData.set_transmit_duration(1000);
+    _deviceData.set_sample_period(80);
+    _deviceData.set_transmit_frequency(700);
+    _deviceData.set_number_of_samples(numberOfSamples);
+    _deviceData.set_data_length(numberOfSamples);
 
     for (int i = 0; i < numberOfSamples; i++) {
         float point;
@@ -66,11 +69,11 @@ void Ping360SimulationLink::randomUpdate()
         } else {
             point = 0.45 * randomPoint<uint8_t>();
         }
-        deviceData.set_data_at(i, point);
+        _deviceData.set_data_at(i, point);
     }
 
-    deviceData.updateChecksum();
-    emit newData(QByteArray(reinterpret_cast<const char*>(deviceData.msgData), deviceData.msgDataLength()));
+    PingChecksum::update(_deviceData);
+    emit newData(QByteArray(reinterpret_cast<const char*>(_deviceData.msgData), _deviceData.msgDataLength()));
 
     // Calculate the global average time between requests
     _counter++;
@@ -91,11 +94,9 @@ void Ping360SimulationLink::randomUpdate()
         printf("%s: Average elapsed request elapsed time %f [Valid: %f]\n", __PRETTY_FUNCTION__, _globalAverageTimeMs,
             simulationTest.maxAverageRequestTimeMs);
 
-        if (_globalAverageTimeMs > simulationTest.maxAverageRequestTimeMs) {
-            QCoreApplication::exit(-1);
-        } else {
-            QCoreApplication::exit(0);
-        }
+        // The simulation can run in a link thread, the application is closed by its own thread
+        const int result = _globalAverageTimeMs > simulationTest.maxAverageRequestTimeMs ? -1 : 0;
+        QMetaObject::invokeMethod(qApp, [result] { QCoreApplication::exit(result); }, Qt::QueuedConnection);
     }
 #endif
 }
@@ -4,6 +4,8 @@
 #include <QElapsedTimer>
 #include <QTimer>
 
+#include <ping-message-ping360.h>
+
 /**
  * @brief Link that simulates Ping sensor behaviour
  *
@@ -40,6 +42,7 @@ public:
 
 private:
     int _counter;
+    ping360_device_data _deviceData;
     QElapsedTimer _elapsedTimer;
     float _globalAverageTimeMs;
     int _spins;
@@ -1,86 +1,404 @@
 #include <QDebug>
+#include <QElapsedTimer>
+#include <QMutexLocker>
 
 #include <algorithm>
+#include <cstring>
 
 #include "logger.h"
 #include "processlog.h"
 
 PING_LOGGING_CATEGORY(PING_PROCESSLOG, "ping.ProcessLog");
 
+namespace {
+// Time used to index packets in each iteration of the playback loop
+const int indexTimeBudgetMs = 5;
+// Packets added to the keyframes in each iteration of the playback loop, a sidecar index is complete when loaded
+const int keyframePacketsBudget = 100000;
+// Packages sent and not processed by the receiver before the playback waits
+const int maximumPendingPackages = 64;
+// Minimum time between packageSizeChanged signals while the log is indexed
+const int packageSizeUpdateMs = 200;
+const qint64 dayUs = 24ll * 60 * 60 * 1000 * 1000;
+}
+
 ProcessLog::ProcessLog(QObject* parent)
     : QObject(parent)
+    , _firstPacketOffset(0)
+    , _indexComplete(false)
+    , _indexSize(0)
+    , _map(nullptr)
+    , _blockOffset(-1)
+    , _version(0)
+    , _dayOffsetUs(0)
+    , _lastTimestampUs(0)
     , _logIndex(0)
+    , _pendingPackages(0)
     , _play(true)
-    , _replayTimeMs(0)
-    , _sleepTime(0)
+    , _seek(false)
     , _stop(false)
 {
 }
 
+void ProcessLog::setLogFile(const QString& fileName, qint64 firstPacketOffset, uint version, const QString& timeFormat)
+{
+    _file.setFileName(fileName);
+    _firstPacketOffset = firstPacketOffset;
+    _version = version;
+    _timeFormat = timeFormat;
+}
+
+bool ProcessLog::openLogFile()
+{
+    if (!_file.open(QIODevice::ReadOnly)) {
+        qCWarning(PING_PROCESSLOG) << "Failed to open log file:" << _file.fileName() << _file.errorString();
+        return false;
+    }
+
+    // The map can fail with big files in 32 bits systems, the packets are read from the file in this case
+    _map = _file.map(0, _file.size());
+    if (!_map) {
+        qCDebug(PING_PROCESSLOG) << "Log file can't be memory mapped:" << _file.errorString();
+    }
+
+    if (_index.load(_file.fileName())) {
+        _indexSize = _index.size();
+        _indexComplete = true;
+        return true;
+    }
+
+    _indexStream.setDevice(&_file);
+    _file.seek(_firstPacketOffset);
+    return true;
+}
+
+bool ProcessLog::indexAll()
+{
+    if (!openLogFile()) {
+        return false;
+    }
+
+    while (!_indexComplete) {
+        indexPackets(indexTimeBudgetMs);
+    }
+    return true;
+}
+
+void ProcessLog::indexPackets(int timeBudgetMs)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    QVector<LogIndex::Entry> packets;
+    bool complete = false;
+    while (timer.elapsed() < timeBudgetMs) {
+        if (!readNextRecord(packets)) {
+            complete = true;
+            break;
+        }
+    }
+
+    if (!packets.isEmpty()) {
+        QMutexLocker locker(&_indexMutex);
+        _index.append(packets);
+        _indexSize = _index.size();
+    }
+    _indexComplete = complete;
+
+    if (complete) {
+        qCDebug(PING_PROCESSLOG) << "Log indexed with" << _indexSize << "packets.";
+    }
+}
+
+bool ProcessLog::readNextRecord(QVector<LogIndex::Entry>& packets)
+{
+    LogIndex::Entry packet {0, 0, 0, LogIndex::noBlock, 0, LogIndex::noAngle};
+
+    if (_version >= 2) {
+        uchar data[LogRecordHeader::size];
+        if (_file.read(reinterpret_cast<char*>(data), sizeof(data)) != sizeof(data)) {
+            qCDebug(PING_PROCESSLOG) << "No more packages !";
+            return false;
+        }
+
+        const auto header = LogRecordHeader::deserialize(data);
+        if (header.type == LogRecordHeader::Block) {
+            return readBlock(header, packets);
+        }
+        if (header.type != LogRecordHeader::Packet) {
+            qCWarning(PING_PROCESSLOG) << "Unknown log record type:" << header.type;
+            return false;
+        }
+        packet.offset = _file.pos();
+        packet.length = header.length;
+        packet.timestampUs = header.timestampUs;
+    } else {
+        // Version 1 packets are saved as a time string followed by the data byte array
+        QString time;
+        quint32 length;
+        _indexStream >> time >> length;
+        if (_indexStream.status() != QDataStream::Ok || time.isEmpty()) {
+            qCDebug(PING_PROCESSLOG) << "No more packages !";
+            return false;
+        }
+
+        // Null byte arrays are saved with 0xFFFFFFFF as length
+        packet.offset = _file.pos();
+        packet.length = length == 0xFFFFFFFF ? 0 : length;
+
+        // The time of the day wraps at midnight, big negative steps are considered as a new day
+        const qint64 timestampUs
+            = QTime::fromString(time, _timeFormat).msecsSinceStartOfDay() * 1000ll + _dayOffsetUs;
+        if (timestampUs < _lastTimestampUs - dayUs / 2) {
+            _dayOffsetUs += dayUs;
+            packet.timestampUs = timestampUs + dayUs;
+        } else {
+            packet.timestampUs = timestampUs;
+        }
+        _lastTimestampUs = packet.timestampUs;
+    }
+
+    if (packet.offset + packet.length > _file.size()) {
+        qCWarning(PING_PROCESSLOG) << "Log file ends in the middle of a packet, it'll be ignored.";
+        return false;
+    }
+
+    // Only the message header is necessary to describe the packet, the keyframes need it after a seek
+    const quint32 headerLength = std::min(packet.length, 16u);
+    if (_map) {
+        LogIndex::describePacket(
+            QByteArray::fromRawData(reinterpret_cast<const char*>(_map + packet.offset), headerLength), packet);
+    } else {
+        // The file is in the beginning of the packet data
+        LogIndex::describePacket(_file.peek(headerLength), packet);
+    }
+    _file.seek(packet.offset + packet.length);
+    packets.append(packet);
+    return true;
+}
+
+bool ProcessLog::readBlock(const LogRecordHeader& header, QVector<LogIndex::Entry>& packets)
+{
+    const qint64 blockOffset = _file.pos();
+    if (blockOffset + header.length > _file.size()) {
+        qCWarning(PING_PROCESSLOG) << "Log file ends in the middle of a block, it'll be ignored.";
+        return false;
+    }
+    _file.seek(blockOffset + header.length);
+
+    const QByteArray& block = decompressBlock(blockOffset, header.length);
+    if (block.isEmpty()) {
+        qCWarning(PING_PROCESSLOG) << "Failed to decompress block at:" << blockOffset;
+        return false;
+    }
+
+    // Blocks contain a sequence of packet records
+    const auto data = reinterpret_cast<const uchar*>(block.constData());
+    int position = 0;
+    while (position + LogRecordHeader::size <= block.size()) {
+        const auto packetHeader = LogRecordHeader::deserialize(data + position);
+        position += LogRecordHeader::size;
+        if (packetHeader.type != LogRecordHeader::Packet
+            || packetHeader.length > static_cast<quint32>(block.size() - position)) {
+            qCWarning(PING_PROCESSLOG) << "Invalid packet record in block at:" << blockOffset;
+            break;
+        }
+
+        LogIndex::Entry packet {blockOffset, static_cast<qint64>(packetHeader.timestampUs), packetHeader.length,
+            position, 0, LogIndex::noAngle};
+        LogIndex::describePacket(block.mid(position, std::min(packetHeader.length, 16u)), packet);
+        packets.append(packet);
+        position += packetHeader.length;
+    }
+    return true;
+}
+
+const QByteArray& ProcessLog::decompressBlock(qint64 offset, quint32 length)
+{
+    if (offset == _blockOffset) {
+        return _block;
+    }
+
+    if (_map) {
+        _block = qUncompress(_map + offset, length);
+    } else {
+        // The index position should be restored after the block read
+        const qint64 indexPosition = _file.pos();
+        _file.seek(offset);
+        _block = qUncompress(_file.read(length));
+        _file.seek(indexPosition);
+    }
+    _blockOffset = offset;
+    return _block;
+}
+
+void ProcessLog::restoreKeyframe(int index)
+{
+    _keyframes.update(_index, index);
+    const QVector<int> packets = _keyframes.latestPackets(_index, index);
+    if (packets.isEmpty()) {
+        return;
+    }
+
+    qCDebug(PING_PROCESSLOG) << "Restoring" << packets.size() << "packets before:" << index;
+    for (const int packet : packets) {
+        sendPackage(packet);
+    }
+}
+
+void ProcessLog::sendPackage(int index)
+{
+    _pendingPackages++;
+    emit newPackage(readPacket(index));
+}
+
+QByteArray ProcessLog::readPacket(int index)
+{
+    const LogIndex::Entry packet = _index.at(index);
+    if (packet.blockOffset != LogIndex::noBlock) {
+        // The block length is available in the record header, before the block data
+        uchar headerData[LogRecordHeader::size];
+        if (_map) {
+            memcpy(headerData, _map + packet.offset - LogRecordHeader::size, sizeof(headerData));
+        } else {
+            const qint64 indexPosition = _file.pos();
+            _file.seek(packet.offset - LogRecordHeader::size);
+            _file.read(reinterpret_cast<char*>(headerData), sizeof(headerData));
+            _file.seek(indexPosition);
+        }
+        const auto header = LogRecordHeader::deserialize(headerData);
+        return decompressBlock(packet.offset, header.length).mid(packet.blockOffset, packet.length);
+    }
+
+    if (_map) {
+        return QByteArray(reinterpret_cast<const char*>(_map + packet.offset), packet.length);
+    }
+
+    // The index stream position should be restored after the packet read
+    const qint64 indexPosition = _file.pos();
+    _file.seek(packet.offset);
+    const QByteArray data = _file.read(packet.length);
+    _file.seek(indexPosition);
+    return data;
+}
+
 void ProcessLog::run()
 {
-    int diffMSecs = 0;
-    int lastMSecs = 0;
+    if (!openLogFile()) {
+        return;
+    }
+    emit packageSizeChanged();
+
+    QElapsedTimer packageSizeTimer;
+    packageSizeTimer.start();
 
     while (!_stop) {
-        // Check for pause condition and valid log index
-        if (!_play) {
-            QThread::msleep(200);
-            continue;
+        // Index the log in small steps, the playback does not need to wait for the entire file
+        if (!_indexComplete) {
+            indexPackets(indexTimeBudgetMs);
+            if (_indexComplete || packageSizeTimer.elapsed() > packageSizeUpdateMs) {
+                packageSizeTimer.restart();
+                emit packageSizeChanged();
+            }
         }
 
-        const QByteArray& data = _log[_logIndex].data;
-        lastMSecs = _log[_logIndex].time.msecsSinceStartOfDay();
-        emit packageIndexChanged(_logIndex);
-        emit newPackage(data);
+        if (_keyframes.size() < _indexSize) {
+            _keyframes.update(_index, _keyframes.size() + keyframePacketsBudget);
+        }
 
-        _logIndex++;
-        // Check if we have data before sending
-        if (_logIndex >= _log.size()) {
-            qCDebug(PING_PROCESSLOG) << "End of the log.";
+        // The display is restored while paused, the user can look at the log position
+        if (_seek.exchange(false) && _logIndex < _indexSize) {
+            restoreKeyframe(_logIndex);
+        }
 
-            // Restart thread and wait for user interaction
-            _logIndex = 0;
-            _play = false;
+        // Check for pause condition and valid log index
+        if (!_play || _logIndex >= _indexSize) {
+            // Logs without packets end without playing
+            if (_play && _indexComplete && _indexSize == 0) {
+                _play = false;
+                emit endOfLog();
+            }
+
+            // Keep indexing while paused
+            if (_indexComplete) {
+                QThread::msleep(200);
+            }
+            continue;
+        }
+
+        // Wait for the receiver, the packages are not accumulated in its event queue
+        if (_pendingPackages >= maximumPendingPackages) {
+            QThread::usleep(500);
             continue;
         }
 
-        diffMSecs = _log[_logIndex].time.msecsSinceStartOfDay() - lastMSecs;
+        const int logIndex = _logIndex;
+        const qint64 timestampUs = _index.at(logIndex).timestampUs;
 
         // Something is wrong, we need to go 'back to the future'
-        if (diffMSecs < 0) {
+        // Version 2 logs have monotonic timestamps, this can only happen with version 1 logs
+        if (logIndex > 0 && timestampUs < _index.at(logIndex - 1).timestampUs) {
             qCWarning(PING_PROCESSLOG) << "Sample time is negative from previous sample! Trying to recover..";
-            qCDebug(PING_PROCESSLOG) << "First time:" << _log.constFirst().time;
-            qCDebug(PING_PROCESSLOG) << "Last time:" << _log.constLast().time;
-            qCDebug(PING_PROCESSLOG) << "Actual index:" << _logIndex << "Time[n-1, n]:" << _log[_logIndex - 1].time
-                                     << _log[_logIndex].time;
+            qCDebug(PING_PROCESSLOG) << "First time [us]:" << _index.at(0).timestampUs;
+            qCDebug(PING_PROCESSLOG) << "Last time [us]:" << _index.at(_indexSize - 1).timestampUs;
+            qCDebug(PING_PROCESSLOG) << "Actual index:" << logIndex << "Time[n-1, n] [us]:"
+                                     << _index.at(logIndex - 1).timestampUs << timestampUs;
+            _scheduler.resync();
+        }
+
+        // The packet is sent in its deadline, the wait is interrupted by a pause, a seek or a speed change
+        if (!_scheduler.wait(timestampUs)) {
             continue;
         }
 
-        _sleepTime = _replayTimeMs ? _replayTimeMs.load() : diffMSecs;
-        _sleepTime = std::min(_sleepTime.load(), diffMSecs);
-        while (_sleepTime > 0) {
-            QThread::msleep(10);
-            _sleepTime -= 10;
+        emit packageIndexChanged(logIndex);
+        sendPackage(logIndex);
+
+        // A seek during the packet read has priority
+        int expectedIndex = logIndex;
+        _logIndex.compare_exchange_strong(expectedIndex, logIndex + 1);
+        // Wait for the next packet to be indexed
+        while (!_indexComplete && _logIndex >= _indexSize) {
+            indexPackets(indexTimeBudgetMs);
+        }
+
+        // Check if we have data before sending
+        if (_logIndex >= _indexSize) {
+            const auto& statistics = _scheduler.statistics();
+            qCDebug(PING_PROCESSLOG) << "End of the log, replay drift [us]: mean" << statistics.meanDriftUs() << "max"
+                                     << statistics.maxDriftUs.load() << "resyncs" << statistics.resyncs.load();
+
+            // Restart thread and wait for user interaction
+            _logIndex = 0;
+            _play = false;
+            _scheduler.resync();
+            emit endOfLog();
         }
     }
 }
 
 QTime ProcessLog::totalTime()
 {
-    int totalMSecs = _log.constLast().time.msecsSinceStartOfDay() - _log.constFirst().time.msecsSinceStartOfDay();
+    QMutexLocker locker(&_indexMutex);
+    if (_index.isEmpty()) {
+        return QTime::fromMSecsSinceStartOfDay(0);
+    }
+
+    int totalMSecs = (_index.at(_index.size() - 1).timestampUs - _index.at(0).timestampUs) / 1000;
     return QTime::fromMSecsSinceStartOfDay(totalMSecs);
 }
 
 QTime ProcessLog::elapsedTime()
 {
-    if (_logIndex < 0) {
+    const int logIndex = _logIndex;
+    if (logIndex < 0) {
         return QTime::fromMSecsSinceStartOfDay(0);
-    } else if (_logIndex >= _log.size()) {
+    } else if (logIndex >= _indexSize) {
         return totalTime();
     }
 
-    int elapsedMSecs = _log[_logIndex].time.msecsSinceStartOfDay() - _log.constFirst().time.msecsSinceStartOfDay();
+    QMutexLocker locker(&_indexMutex);
+    int elapsedMSecs = (_index.at(logIndex).timestampUs - _index.at(0).timestampUs) / 1000;
     return QTime::fromMSecsSinceStartOfDay(elapsedMSecs);
 }
 
@@ -3,16 +3,28 @@
 #include <atomic>
 
 #include <QByteArray>
+#include <QDataStream>
+#include <QFile>
 #include <QLoggingCategory>
+#include <QMutex>
 #include <QThread>
 #include <QTime>
 #include <QVector>
 
+#include "logindex.h"
+#include "logkeyframes.h"
+#include "logsensorstruct.h"
+#include "replayscheduler.h"
+
 Q_DECLARE_LOGGING_CATEGORY(PING_PROCESSLOG)
 
 /**
  * @brief Play sensor logs
- *
+ *  Packets are read on demand from the log file, only an index with the position and time of each packet is kept
+ *  in memory. The sidecar index of the log is used when valid, otherwise the index is built by the playback thread
+ *  while the log is played. The playback starts after the first packet and does not depend of the log size.
+ *  Ping360 keyframes are built together with the index, a seek sends the latest packet of each angle before the new
+ *  position, so the polar image is complete without waiting for a full rotation.
  */
 class ProcessLog : public QObject {
     Q_OBJECT
@@ -31,12 +43,23 @@ public:
     ~ProcessLog();
 
     /**
-     * @brief Append new log message
+     * @brief Set the log file that will be played
+     *  This should be called before run
+     *
+     * @param fileName
+     * @param firstPacketOffset position of the first packet in the file, after the log header
+     * @param version log format version, check LogSensorStruct
+     * @param timeFormat format of the packet timestamps in version 1 logs
+     */
+    void setLogFile(const QString& fileName, qint64 firstPacketOffset, uint version, const QString& timeFormat);
+
+    /**
+     * @brief Check if all packets of the log file are indexed
      *
-     * @param time
-     * @param data
+     * @return true
+     * @return false
      */
-    void append(QTime time, QByteArray data) { _log.append(Pack {time, data}); };
+    bool isIndexComplete() const { return _indexComplete; }
 
     /**
      * @brief Return log elapsed time
@@ -57,19 +80,27 @@ public:
      *
      * @return int
      */
-    int packageSize() { return _log.size() - 1; };
+    int packageSize() { return _indexSize - 1; };
 
     /**
      * @brief Pause log
      *
      */
-    void pause() { _play = false; };
+    void pause()
+    {
+        _play = false;
+        _scheduler.resync();
+    };
 
     /**
      * @brief Stop log
      *
      */
-    void stop() { _stop = true; };
+    void stop()
+    {
+        _stop = true;
+        _scheduler.resync();
+    };
 
     /**
      * @brief Set the package index
@@ -78,9 +109,10 @@ public:
      */
     void setPackageIndex(int index)
     {
-        if (_logIndex < _log.size()) {
+        if (index >= 0 && index < _indexSize) {
             _logIndex = index;
-            _sleepTime = 0;
+            _seek = true;
+            _scheduler.resync();
         }
     }
 
@@ -92,7 +124,7 @@ public:
     {
         _play = true;
         _stop = false;
-        _sleepTime = 0;
+        _scheduler.resync();
     };
 
     /**
@@ -112,33 +144,149 @@ public:
     QTime totalTime();
 
     /**
-     * @brief Set the time between each message
+     * @brief Set the replay speed
+     *
+     * @param speed multiplier of the log time, ReplayScheduler::asFastAsPossible to play without waiting
+     */
+    void setReplaySpeed(double speed) { _scheduler.setSpeed(speed); }
+
+    /**
+     * @brief Set the maximum time between each message, longer gaps of the log are shortened
      *  Set time to 0 for real-time
      *
-     * @param replayTimeMs
+     * @param maximumIntervalMs
      */
-    void setReplayTimeMs(int replayTimeMs)
-    {
-        _replayTimeMs = replayTimeMs;
-        _sleepTime = 0;
-    }
+    void setMaximumIntervalMs(int maximumIntervalMs) { _scheduler.setMaximumIntervalUs(maximumIntervalMs * 1000ll); }
+
+    /**
+     * @brief Return how far the replay is from the packet timestamps
+     *
+     * @return const ReplayScheduler::Statistics&
+     */
+    const ReplayScheduler::Statistics& replayStatistics() const { return _scheduler.statistics(); }
+
+    /**
+     * @brief Notify that a package sent by newPackage was processed, it should be called by the receiver
+     *  The playback waits when the receiver has too many packages to process, E.g: playing as fast as possible
+     *
+     */
+    void packageProcessed() { _pendingPackages--; }
+
+    /**
+     * @brief Open the log file and index all packets without playing them, E.g: to describe the log
+     *  This blocks until the log is indexed, it should not be used together with run
+     *
+     * @return true if the log file was opened
+     * @return false
+     */
+    bool indexAll();
+
+    /**
+     * @brief Return the packet index, it's complete after indexAll
+     *
+     * @return const LogIndex&
+     */
+    const LogIndex& index() const { return _index; }
+
+    /**
+     * @brief Read the data of a packet from the log file
+     *  It should be called by the playback thread, or after indexAll
+     *
+     * @param index
+     * @return QByteArray
+     */
+    QByteArray readPacket(int index);
 
 signals:
+    void endOfLog();
     void newPackage(const QByteArray& data);
     void packageIndexChanged(int index);
+    void packageSizeChanged();
 
 private:
-    void processJob();
+    /**
+     * @brief Open the log file for reading, it's memory mapped when possible
+     *
+     * @return true
+     * @return false
+     */
+    bool openLogFile();
 
-    struct Pack {
-        QTime time;
-        QByteArray data;
-    };
+    /**
+     * @brief Index the next packets of the log file
+     *
+     * @param timeBudgetMs maximum time used to index packets
+     */
+    void indexPackets(int timeBudgetMs);
+
+    /**
+     * @brief Read the position and time of the packets in the next record of the log file
+     *
+     * @param packets output list, the new packets are appended
+     * @return true if a record was read
+     * @return false if the end of the log was reached
+     */
+    bool readNextRecord(QVector<LogIndex::Entry>& packets);
+
+    /**
+     * @brief Read the packets of a compressed block
+     *
+     * @param header block record header, the file should be at the block data position
+     * @param packets output list, the new packets are appended
+     * @return true if the block was read
+     * @return false if the block is not valid
+     */
+    bool readBlock(const LogRecordHeader& header, QVector<LogIndex::Entry>& packets);
+
+    /**
+     * @brief Return the uncompressed data of a block
+     *  The last block is cached, since consecutive packets are usually in the same block
+     *
+     * @param offset position of the compressed block data in the file
+     * @param length length of the compressed block data
+     * @return const QByteArray& empty if the block is not valid
+     */
+    const QByteArray& decompressBlock(qint64 offset, quint32 length);
+
+    /**
+     * @brief Read a packet and send it with newPackage
+     *
+     * @param index
+     */
+    void sendPackage(int index);
+
+    /**
+     * @brief Send the latest packet of each angle before a packet, restoring the state of the sensor at this packet
+     *
+     * @param index
+     */
+    void restoreKeyframe(int index);
+
+    QFile _file;
+    qint64 _firstPacketOffset;
+    LogIndex _index;
+    // Protect _index, it's written by the playback thread and read by the others
+    QMutex _indexMutex;
+    std::atomic<bool> _indexComplete;
+    std::atomic<int> _indexSize;
+    // Only used by the playback thread
+    LogKeyframes _keyframes;
+    QDataStream _indexStream;
+    // Memory mapped log file, nullptr if the map is not possible
+    const uchar* _map;
+    // Last uncompressed block and the position of its compressed data in the file
+    QByteArray _block;
+    qint64 _blockOffset;
+    QString _timeFormat;
+    uint _version;
+    // Version 1 timestamps are the time of the day, they are converted to a monotonic timestamp
+    qint64 _dayOffsetUs;
+    qint64 _lastTimestampUs;
 
-    QVector<Pack> _log;
     std::atomic<int> _logIndex;
+    std::atomic<int> _pendingPackages;
     std::atomic<bool> _play;
-    std::atomic<int> _replayTimeMs;
-    std::atomic<int> _sleepTime;
+    ReplayScheduler _scheduler;
+    std::atomic<bool> _seek;
     std::atomic<bool> _stop;
 };
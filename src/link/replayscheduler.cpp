@@ -0,0 +1,86 @@
+#include <algorithm>
+
+#include <QThread>
+
+#include "logger.h"
+#include "replayscheduler.h"
+
+PING_LOGGING_CATEGORY(PING_REPLAYSCHEDULER, "ping.replayscheduler");
+
+namespace {
+// The thread yields instead of sleeping in the last part of the wait, sleeps can wake up late
+const qint64 spinNs = 500 * 1000;
+// Maximum sleep, a resync is noticed by the waiting thread in this interval
+const qint64 maximumSleepNs = 10 * 1000 * 1000;
+// Packets later than this restart the origin, otherwise the next packets would be released in a burst
+const qint64 maximumLateUs = 250 * 1000;
+}
+
+ReplayScheduler::ReplayScheduler()
+    : _originClockNs(0)
+    , _originTimestampUs(0)
+    , _lastTimestampUs(0)
+    , _maximumIntervalUs(0)
+    , _resync(true)
+    , _speed(1)
+{
+    _clock.start();
+}
+
+void ReplayScheduler::setSpeed(double speed)
+{
+    _speed = std::max(speed, asFastAsPossible);
+    resync();
+}
+
+void ReplayScheduler::resync() { _resync = true; }
+
+void ReplayScheduler::restartOrigin(qint64 timestampUs)
+{
+    _originClockNs = _clock.nsecsElapsed();
+    _originTimestampUs = timestampUs;
+    _lastTimestampUs = timestampUs;
+    _statistics.resyncs++;
+}
+
+bool ReplayScheduler::wait(qint64 timestampUs)
+{
+    const double speed = _speed;
+    if (_resync.exchange(false) || speed == asFastAsPossible) {
+        restartOrigin(timestampUs);
+        return true;
+    }
+
+    // The origin is moved to skip the part of the gap that is longer than the maximum interval
+    const qint64 intervalUs = timestampUs - _lastTimestampUs;
+    if (_maximumIntervalUs > 0 && intervalUs > _maximumIntervalUs) {
+        _originTimestampUs += intervalUs - _maximumIntervalUs;
+    }
+    _lastTimestampUs = timestampUs;
+
+    const qint64 deadlineNs = _originClockNs + static_cast<qint64>((timestampUs - _originTimestampUs) * 1000 / speed);
+    qint64 remainingNs = deadlineNs - _clock.nsecsElapsed();
+    while (remainingNs > spinNs) {
+        QThread::usleep(std::min(remainingNs - spinNs, maximumSleepNs) / 1000);
+        if (_resync) {
+            return false;
+        }
+        remainingNs = deadlineNs - _clock.nsecsElapsed();
+    }
+    while (remainingNs > 0) {
+        QThread::yieldCurrentThread();
+        remainingNs = deadlineNs - _clock.nsecsElapsed();
+    }
+
+    const qint64 driftUs = -remainingNs / 1000;
+    _statistics.lastDriftUs = driftUs;
+    _statistics.maxDriftUs = std::max(_statistics.maxDriftUs.load(), driftUs);
+    _statistics.totalDriftUs += driftUs;
+    _statistics.packets++;
+
+    if (driftUs > maximumLateUs) {
+        qCDebug(PING_REPLAYSCHEDULER) << "Packet released" << driftUs << "us after its deadline, restarting origin.";
+        restartOrigin(timestampUs);
+    }
+    return true;
+}
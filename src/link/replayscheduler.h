@@ -0,0 +1,112 @@
+#pragma once
+
+#include <atomic>
+
+#include <QElapsedTimer>
+#include <QtGlobal>
+
+/**
+ * @brief Pace the packets of a log replay with their timestamps
+ *  Each packet has a deadline in a monotonic clock, calculated from the log time elapsed since an origin packet and
+ *  the replay speed. Waiting for an absolute deadline does not accumulate the sleep errors of each packet, the thread
+ *  sleeps until close to the deadline and yields for the rest of the time, giving sub-millisecond accuracy.
+ *  The origin is restarted after a seek, a speed change or a packet that is too late, the next packet is sent
+ *  immediately.
+ */
+class ReplayScheduler {
+public:
+    /**
+     * @brief Pacing statistics, they can be read by other threads
+     *  The drift is the time between the deadline of a packet and the time it's released, packets are never early
+     *
+     */
+    struct Statistics {
+        std::atomic<qint64> lastDriftUs {0};
+        std::atomic<qint64> maxDriftUs {0};
+        std::atomic<qint64> totalDriftUs {0};
+        // Number of packets released on a deadline
+        std::atomic<quint64> packets {0};
+        // Origin restarts after a seek, a speed change or a late packet
+        std::atomic<quint64> resyncs {0};
+
+        /**
+         * @brief Return the mean drift of the packets
+         *
+         * @return double
+         */
+        double meanDriftUs() const { return packets ? static_cast<double>(totalDriftUs) / packets : 0; }
+    };
+
+    // Speed that releases the packets without waiting
+    static constexpr double asFastAsPossible = 0;
+
+    /**
+     * @brief Construct a new Replay Scheduler object with real time speed
+     *
+     */
+    ReplayScheduler();
+
+    /**
+     * @brief Set the replay speed, this can be called by any thread
+     *
+     * @param speed multiplier of the log time (E.g: 4 plays the log 4 times faster), asFastAsPossible to not wait
+     */
+    void setSpeed(double speed);
+
+    /**
+     * @brief Return the replay speed
+     *
+     * @return double
+     */
+    double speed() const { return _speed; }
+
+    /**
+     * @brief Set the maximum log time between consecutive packets, longer gaps of the log are shortened
+     *  This can be called by any thread
+     *
+     * @param maximumIntervalUs 0 to keep all gaps
+     */
+    void setMaximumIntervalUs(qint64 maximumIntervalUs) { _maximumIntervalUs = maximumIntervalUs; }
+
+    /**
+     * @brief Restart the origin with the next packet, a wait in progress is interrupted
+     *  This can be called by any thread, E.g: after a seek or a pause
+     *
+     */
+    void resync();
+
+    /**
+     * @brief Wait until the deadline of a packet, it should be called by the replay thread
+     *
+     * @param timestampUs log timestamp of the packet
+     * @return true when the packet should be released
+     * @return false if the wait was interrupted by resync
+     */
+    bool wait(qint64 timestampUs);
+
+    /**
+     * @brief Return the pacing statistics
+     *
+     * @return const Statistics&
+     */
+    const Statistics& statistics() const { return _statistics; }
+
+private:
+    /**
+     * @brief Restart the origin with a packet, it's released now
+     *
+     * @param timestampUs
+     */
+    void restartOrigin(qint64 timestampUs);
+
+    QElapsedTimer _clock;
+    // Log time and clock time of the origin packet
+    qint64 _originClockNs;
+    qint64 _originTimestampUs;
+    qint64 _lastTimestampUs;
+
+    std::atomic<qint64> _maximumIntervalUs;
+    std::atomic<bool> _resync;
+    std::atomic<double> _speed;
+    Statistics _statistics;
+};
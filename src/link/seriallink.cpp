@@ -21,18 +21,17 @@ PING_LOGGING_CATEGORY(PING_PROTOCOL_SERIALLINK, "ping.protocol.seriallink")
 
 SerialLink::SerialLink(QObject* parent)
     : AbstractLink("SerialLink", parent)
+    , _port(&_ioContext)
 {
     setType(LinkType::Serial);
 
     connect(&_port, &QIODevice::readyRead, this, [this]() { emit newData(_port.readAll()); }, Qt::DirectConnection);
 
-    connect(
-        this, &AbstractLink::sendData, this,
-        [this](const QByteArray& data) {
-            _port.write(data);
-            _port.flush();
-        },
-        Qt::DirectConnection);
+    // Written by the thread of the port
+    connect(this, &AbstractLink::sendData, &_port, [this](const QByteArray& data) {
+        _port.write(data);
+        _port.flush();
+    });
 
     connect(&_port, &QSerialPort::errorOccurred, this, [this](QSerialPort::SerialPortError error) {
         switch (error) {
@@ -66,29 +65,33 @@ bool SerialLink::setConfiguration(const LinkConfiguration& linkConfiguration)
 
 bool SerialLink::startConnection()
 {
-    // Check if port was already open
-    if (isOpen()) {
-        qCDebug(PING_PROTOCOL_SERIALLINK) << "Serial port will be restarted.";
-        finishConnection();
-    }
+    return callInIoThread([this] {
+        // Check if port was already open
+        if (isOpen()) {
+            qCDebug(PING_PROTOCOL_SERIALLINK) << "Serial port will be restarted.";
+            finishConnection();
+        }
 
-    if (!_port.open(QIODevice::ReadWrite)) {
-        qCWarning(PING_PROTOCOL_SERIALLINK) << QStringLiteral("Fail to open serial port: %1, error: %2")
-                                                   .arg(_linkConfiguration.createFullConfString(), _port.error());
-        return false;
-    }
+        if (!_port.open(QIODevice::ReadWrite)) {
+            qCWarning(PING_PROTOCOL_SERIALLINK) << QStringLiteral("Fail to open serial port: %1, error: %2")
+                                                       .arg(_linkConfiguration.createFullConfString(), _port.error());
+            return false;
+        }
 
-    forceSensorAutomaticBaudRateDetection();
+        forceSensorAutomaticBaudRateDetection();
 
-    return true;
+        return true;
+    });
 }
 
 bool SerialLink::finishConnection()
 {
-    if (_port.isOpen()) {
-        _port.close();
-        qCDebug(PING_PROTOCOL_SERIALLINK) << "Port closed.";
-    }
+    callInIoThread([this] {
+        if (_port.isOpen()) {
+            _port.close();
+            qCDebug(PING_PROTOCOL_SERIALLINK) << "Port closed.";
+        }
+    });
     return true;
 }
 
@@ -109,15 +112,26 @@ QStringList SerialLink::listAvailableConnections()
 
 void SerialLink::setBaudRate(int baudRate)
 {
-    _port.close();
-    _port.setBaudRate(baudRate);
-    startConnection();
-    setLowLatency();
+    callInIoThread([this, baudRate] {
+        _port.close();
+        _port.setBaudRate(baudRate);
+        startConnection();
+        setLowLatency();
+    });
 
     QStringList args = _linkConfiguration.argsAsConst();
     args[1] = QString::number(baudRate);
     _linkConfiguration.setArgs(args);
-    forceSensorAutomaticBaudRateDetection();
+    callInIoThread([this] { forceSensorAutomaticBaudRateDetection(); });
+}
+
+void SerialLink::waitForBytesWritten()
+{
+    callInIoThread([this] {
+        while (_port.bytesToWrite()) {
+            _port.waitForBytesWritten();
+        }
+    });
 }
 
 #ifdef Q_OS_MACOS
@@ -56,6 +56,7 @@ public:
     /**
      * @brief Return a list of available ports
      * Any change in the port should be notified and dealed via `configurationChanged()`
+     * The port is used by the io thread of the link, it should only be read by other threads
      *
      * @return QSerialPort*
      */
@@ -112,6 +113,12 @@ public:
      */
     bool setLowLatency();
 
+    /**
+     * @brief Wait for the data sent by the link to be written in the port
+     *
+     */
+    void waitForBytesWritten();
+
 private:
     QSerialPort _port;
 };
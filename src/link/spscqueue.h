@@ -0,0 +1,95 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Bounded lock-free queue for a single producer and a single consumer thread
+ *  One slot is kept empty to distinguish a full queue from an empty one.
+ *
+ * @tparam T
+ */
+template <typename T> class SpscQueue {
+public:
+    /**
+     * @brief Construct a new queue
+     *
+     * @param capacity maximum number of items in the queue
+     */
+    explicit SpscQueue(int capacity)
+        : _buffer(capacity + 1)
+        , _head(0)
+        , _tail(0)
+    {
+    }
+
+    /**
+     * @brief Add an item to the queue, should only be called by the producer thread
+     *
+     * @param value
+     * @return true
+     * @return false if the queue is full
+     */
+    bool push(T&& value)
+    {
+        const size_t tail = _tail.load(std::memory_order_relaxed);
+        const size_t next = increment(tail);
+        if (next == _head.load(std::memory_order_acquire)) {
+            return false;
+        }
+
+        _buffer[tail] = std::move(value);
+        _tail.store(next, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Remove the oldest item of the queue, should only be called by the consumer thread
+     *
+     * @param value
+     * @return true
+     * @return false if the queue is empty
+     */
+    bool pop(T& value)
+    {
+        const size_t head = _head.load(std::memory_order_relaxed);
+        if (head == _tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+
+        value = std::move(_buffer[head]);
+        // Release the item resources before the slot is available to the producer
+        _buffer[head] = T();
+        _head.store(increment(head), std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Return an approximation of the number of items, it can change while it's calculated
+     *
+     * @return int
+     */
+    int size() const
+    {
+        const size_t head = _head.load(std::memory_order_acquire);
+        const size_t tail = _tail.load(std::memory_order_acquire);
+        return static_cast<int>(tail >= head ? tail - head : tail + _buffer.size() - head);
+    }
+
+    /**
+     * @brief Return the maximum number of items
+     *
+     * @return int
+     */
+    int capacity() const { return static_cast<int>(_buffer.size() - 1); }
+
+private:
+    size_t increment(size_t index) const { return index + 1 == _buffer.size() ? 0 : index + 1; }
+
+    std::vector<T> _buffer;
+    // Head and tail are written by different threads, keep them in different cache lines
+    alignas(64) std::atomic<size_t> _head;
+    alignas(64) std::atomic<size_t> _tail;
+};
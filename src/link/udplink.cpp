@@ -9,17 +9,19 @@ PING_LOGGING_CATEGORY(PING_PROTOCOL_UDPLINK, "ping.protocol.udplink")
 
 UDPLink::UDPLink(QObject* parent)
     : AbstractLink("UDPLink", parent)
-    , _udpSocket(new QUdpSocket(parent))
+    , _stateTimer(&_ioContext)
+    , _udpSocket(new QUdpSocket(&_ioContext))
 {
     setType(LinkType::Udp);
 
-    connect(_udpSocket, &QIODevice::readyRead, this, [this] { emit newData(_udpSocket->readAll()); });
+    connect(
+        _udpSocket, &QIODevice::readyRead, this, [this] { emit newData(_udpSocket->readAll()); }, Qt::DirectConnection);
     connect(_udpSocket, &QAbstractSocket::errorOccurred, this,
         [this](QAbstractSocket::SocketError /*socketError*/) { printErrorMessage(); });
 
     // QUdpSocket fail to emit state signal
     // Here we use a timer to check if we are in a connect state, if not we try again
-    connect(&_stateTimer, &QTimer::timeout, this, [this] {
+    connect(&_stateTimer, &QTimer::timeout, _udpSocket, [this] {
         if (_udpSocket->state() == QAbstractSocket::UnconnectedState) {
             printErrorMessage();
             qDebug(PING_PROTOCOL_UDPLINK) << "Trying to reconnect with host again.";
@@ -28,7 +30,8 @@ UDPLink::UDPLink(QObject* parent)
     });
     _stateTimer.start(1000);
 
-    connect(this, &AbstractLink::sendData, this, [this](const QByteArray& data) { _udpSocket->write(data); });
+    // Written by the thread of the socket
+    connect(this, &AbstractLink::sendData, _udpSocket, [this](const QByteArray& data) { _udpSocket->write(data); });
 }
 
 bool UDPLink::setConfiguration(const LinkConfiguration& linkConfiguration)
@@ -79,7 +82,10 @@ void UDPLink::printErrorMessage()
 
 bool UDPLink::finishConnection()
 {
-    _udpSocket->close();
+    callInIoThread([this] {
+        _stateTimer.stop();
+        _udpSocket->close();
+    });
     return true;
 }
 
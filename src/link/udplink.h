@@ -61,7 +61,10 @@ public:
      * @return true
      * @return false
      */
-    bool startConnection() final { return _udpSocket->open(QIODevice::ReadWrite); };
+    bool startConnection() final
+    {
+        return callInIoThread([this] { return _udpSocket->open(QIODevice::ReadWrite); });
+    };
 
     /**
      * @brief Return QUdpSocket pointer
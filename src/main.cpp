@@ -12,6 +12,7 @@
 #endif
 
 #include "abstractlink.h"
+#include "batchrenderer.h"
 #include "commandlineparser.h"
 #include "devicemanager.h"
 #include "filemanager.h"
@@ -24,6 +25,7 @@
 #include "ping360.h"
 #include "ping360helperservice.h"
 #include "polarplot.h"
+#include "profile.h"
 #include "settingsmanager.h"
 #include "stylemanager.h"
 #include "util.h"
@@ -49,6 +51,7 @@ int main(int argc, char* argv[])
     qRegisterMetaType<AbstractLinkNamespace::LinkType>();
     qRegisterMetaType<PingEnumNamespace::PingDeviceType>();
     qRegisterMetaType<PingEnumNamespace::PingMessageId>();
+    qRegisterMetaType<Profile>();
 
     qmlRegisterSingletonType<DeviceManager>(
         "DeviceManager", 1, 0, "DeviceManager", DeviceManager::qmlSingletonRegister);
@@ -85,10 +88,24 @@ int main(int argc, char* argv[])
     QApplication::setAttribute(Qt::AA_EnableHighDpiScaling);
     QCoreApplication::setAttribute(Qt::AA_UseHighDpiPixmaps);
 
+    // Logs are rendered without a window, it should work without a display server
+    for (int i = 1; i < argc; i++) {
+        const QString argument = argv[i];
+        const bool render = argument == "-r" || argument == "--render" || argument.startsWith("--render=");
+        if (render && qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+            qputenv("QT_QPA_PLATFORM", "offscreen");
+        }
+    }
+
     QApplication app(argc, argv);
 
     CommandLineParser parser(app);
 
+    // The QML engine is not created when rendering logs
+    if (!parser.renderFiles().isEmpty()) {
+        return BatchRenderer(parser.renderFiles()).exec();
+    }
+
     QQmlApplicationEngine engine;
 
     // Load the QML and set the Context
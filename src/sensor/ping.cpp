@@ -3,6 +3,7 @@
 #include <functional>
 
 #include <QCoreApplication>
+#include <QDateTime>
 #include <QFileInfo>
 #include <QJsonArray>
 #include <QJsonDocument>
@@ -33,7 +34,6 @@ const uint32_t Ping::_firmwareDefaultSpeedOfSound = 1500;
 
 Ping::Ping()
     : PingSensor(PingDeviceType::PING1D)
-    , _points(_num_points, 0)
 {
     _flasher = new Flasher(nullptr);
 
@@ -42,6 +42,9 @@ Ping::Ping()
     setSensorVisualizer({"qrc:/Ping1DVisualizer.qml"});
     setSensorStatusModel({"qrc:/Ping1DStatusModel.qml"});
 
+    // Profiles are sent continuously, only the last one is necessary
+    setSupersededMessages({Ping1dId::PROFILE});
+
     _periodicRequestTimer.setInterval(1000);
     connect(&_periodicRequestTimer, &QTimer::timeout, this, [this] {
         if (!link()->isWritable()) {
@@ -204,7 +207,7 @@ void Ping::handleMessage(const ping_message& msg)
     } break;
 
     case Ping1dId::PROFILE: {
-        ping1d_profile m(msg);
+        const auto& m = *static_cast<const ping1d_profile*>(&msg);
         _distance = m.distance();
         _confidence = m.confidence();
         _transmit_duration = m.transmit_duration();
@@ -214,17 +217,16 @@ void Ping::handleMessage(const ping_message& msg)
         _gain_setting = m.gain_setting();
         _num_points = m.profile_data_length();
 
-        if (_num_points != _points.size()) {
-            _points.resize(_num_points);
-        }
-#pragma omp for
-        // This is necessary to convert <uint8_t> to <int>
-        // QProperty only supports vector<int>, otherwise, we could use memcpy, like the two lines below:
-        // _num_points = m.profile_data_length(); // const for no
-        // memcpy(_points.data(), m.data(), _num_points); // careful with constant
-        for (int i = 0; i < m.profile_data_length(); i++) {
-            _points.replace(i, m.profile_data()[i] / 255.0);
-        }
+        Profile::Data profile;
+        profile.confidence = _confidence;
+        profile.distance = _distance * 0.001f;
+        profile.gain = _gain_setting;
+        profile.initialPoint = _scan_start * 0.001f;
+        profile.length = _scan_length * 0.001f;
+        profile.pingNumber = _ping_number;
+        profile.samples = QByteArray(reinterpret_cast<const char*>(m.profile_data()), _num_points);
+        profile.timestampMs = QDateTime::currentMSecsSinceEpoch();
+        _profile = Profile(std::move(profile));
 
         emit distanceChanged();
         emit pingNumberChanged();
@@ -234,6 +236,7 @@ void Ping::handleMessage(const ping_message& msg)
         emit scanLengthChanged();
         emit gainSettingChanged();
         emit pointsChanged();
+        emit profileChanged(_profile);
     } break;
 
     case Ping1dId::MODE_AUTO: {
@@ -361,12 +364,9 @@ void Ping::flash(const QString& fileUrl, bool sendPingGotoBootloader, int baud,
     }
 
     // Wait for bytes to be written before finishing the connection
-    while (serialLink->port()->bytesToWrite()) {
-        qCDebug(PING_PROTOCOL_PING) << "Waiting for bytes to be written...";
-        // We are not changing the connection structure, only waiting for bytes to be written
-        const_cast<QSerialPort*>(serialLink->port())->waitForBytesWritten();
-        qCDebug(PING_PROTOCOL_PING) << "Done !";
-    }
+    qCDebug(PING_PROTOCOL_PING) << "Waiting for bytes to be written...";
+    serialLink->waitForBytesWritten();
+    qCDebug(PING_PROTOCOL_PING) << "Done !";
 
     qCDebug(PING_PROTOCOL_PING) << "Finish connection.";
 
@@ -379,7 +379,7 @@ void Ping::flash(const QString& fileUrl, bool sendPingGotoBootloader, int baud,
     };
 
     auto finishConnection = [=] {
-        link()->finishConnection();
+        finishLinkConnection();
 
         QSerialPortInfo pInfo(serialLink->port()->portName());
         QString portLocation = pInfo.systemLocation();
@@ -501,7 +501,7 @@ void Ping::printSensorInformation() const
     qCDebug(PING_PROTOCOL_PING) << "\t- gain_setting:" << _gain_setting;
     qCDebug(PING_PROTOCOL_PING) << "\t- mode_auto:" << _mode_auto;
     qCDebug(PING_PROTOCOL_PING) << "\t- ping_interval:" << _ping_interval;
-    qCDebug(PING_PROTOCOL_PING) << "\t- points:" << QByteArray((const char*)_points.data(), _num_points).toHex(',');
+    qCDebug(PING_PROTOCOL_PING) << "\t- points:" << _profile.samples().toHex(',');
 }
 
 void Ping::checkNewFirmwareInGitHubPayload(const QJsonDocument& jsonDocument)
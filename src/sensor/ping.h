@@ -168,11 +168,12 @@ public:
     Q_PROPERTY(int gain_setting READ gain_setting WRITE set_gain_setting NOTIFY gainSettingChanged)
 
     /**
-     * @brief Return last array of points
+     * @brief Return the last profile normalized to [0-1]
+     *  It's calculated for each call, profile should be used when possible
      *
      * @return QVector<double>
      */
-    QVector<double> points() { return _points; }
+    QVector<double> points() const { return normalizedSamples(_profile.samples()); }
     Q_PROPERTY(QVector<double> points READ points NOTIFY pointsChanged)
 
     /**
@@ -391,15 +392,6 @@ private:
 
     uint16_t _num_points = 0;
 
-    /**
-     * @brief The points received by the sensor
-     *  Such points are shared between the sensor and the interface in a normalized format [1-0]
-     *  Where the maximum value is the max power and 0 the lowest power
-     *  QVector<double> is used to share such points with the QML interface and the viewer widgets
-     *
-     */
-    QVector<double> _points;
-
     bool _mode_auto = 0;
     uint16_t _ping_interval = 0;
     static const int _pingMaxFrequency;
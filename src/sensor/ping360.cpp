@@ -5,6 +5,7 @@
 #include <limits>
 
 #include <QCoreApplication>
+#include <QDateTime>
 #include <QFileInfo>
 #include <QJsonArray>
 #include <QJsonDocument>
@@ -58,8 +59,9 @@ Ping360::Ping360()
 {
     _flasher = new Ping360Flasher(nullptr);
 
-    // QVector crashs when constructed in initialization list
-    _data = QVector<double>(_maxNumberOfPoints, 0);
+    Profile::Data profile;
+    profile.samples = QByteArray(_maxNumberOfPoints, 0);
+    _profile = Profile(std::move(profile));
 
     setName("Ping360");
 
@@ -67,6 +69,9 @@ Ping360::Ping360()
     setSensorVisualizer({"qrc:/Ping360Visualizer.qml"});
     setSensorStatusModel({"qrc:/Ping360StatusModel.qml"});
 
+    // Device data is the answer of the profile requests, only the profiles sent automatically can be dropped
+    setSupersededMessages({Ping360Id::AUTO_DEVICE_DATA});
+
     connect(this, &Sensor::connectionOpen, this, &Ping360::checkBootloader);
 
     // Add timer for worst case scenario
@@ -342,6 +347,23 @@ void Ping360::asyncProfileRequest()
     _timeoutProfileMessage.start(_sensorTimeout);
 }
 
+void Ping360::updateProfile(const uint8_t* samples, int length, int gain)
+{
+    // Update total number of pings
+    if (length) {
+        _ping_number++;
+    }
+
+    Profile::Data profile;
+    profile.angle = _angle;
+    profile.gain = gain;
+    profile.length = range();
+    profile.pingNumber = _ping_number;
+    profile.samples = QByteArray(reinterpret_cast<const char*>(samples), length);
+    profile.timestampMs = QDateTime::currentMSecsSinceEpoch();
+    _profile = Profile(std::move(profile));
+}
+
 void Ping360::handleMessage(const ping_message& msg)
 {
     static uint8_t _waitRetryMessages = 1;
@@ -374,7 +396,7 @@ void Ping360::handleMessage(const ping_message& msg)
 
     case Ping360Id::DEVICE_DATA: {
         // Parse message
-        const ping360_device_data deviceData = *static_cast<const ping360_device_data*>(&msg);
+        const auto& deviceData = *static_cast<const ping360_device_data*>(&msg);
 
         // Get angle to request next message
         _angle = deviceData.angle();
@@ -389,22 +411,16 @@ void Ping360::handleMessage(const ping_message& msg)
             _timeoutProfileMessage.start(profileRunningTimeout);
         }
 
-        _data.resize(deviceData.data_length());
-#pragma omp for
-        for (int i = 0; i < deviceData.data_length(); i++) {
-            _data.replace(i, deviceData.data()[i] / 255.0);
-        }
+        updateProfile(deviceData.data(), deviceData.data_length(), deviceData.gain_setting());
 
         emit angleChanged();
 
         // Only emit data changed when inside sector range
-        if (_data.size()) {
-            // Update total number of pings
-            _ping_number++;
-
+        if (_profile.samples().size()) {
             if (_sectorSize == 400 || (angle() >= _angularResolutionGrad - _sectorSize / 2)
                 || (angle() <= _sectorSize / 2)) {
                 emit dataChanged();
+                emit profileChanged(_profile);
             }
         }
 
@@ -430,25 +446,19 @@ void Ping360::handleMessage(const ping_message& msg)
         _timeoutProfileMessage.stop();
 
         // Parse message
-        const ping360_auto_device_data autoDeviceData = *static_cast<const ping360_auto_device_data*>(&msg);
+        const auto& autoDeviceData = *static_cast<const ping360_auto_device_data*>(&msg);
 
         // Get angle to request next message
         _angle = autoDeviceData.angle();
 
-        _data.resize(autoDeviceData.data_length());
-#pragma omp for
-        for (int i = 0; i < autoDeviceData.data_length(); i++) {
-            _data.replace(i, autoDeviceData.data()[i] / 255.0);
-        }
+        updateProfile(autoDeviceData.data(), autoDeviceData.data_length(), autoDeviceData.gain_setting());
 
         emit angleChanged();
 
         // Only emit data changed when inside sector range
-        if (_data.size()) {
-            // Update total number of pings
-            _ping_number++;
-
+        if (_profile.samples().size()) {
             emit dataChanged();
+            emit profileChanged(_profile);
         }
 
         // This properties are changed internally only when the link is not writable
@@ -593,20 +603,14 @@ void Ping360::flash(const QString& fileUrl, bool sendPingGotoBootloader, int bau
             setBaudRate(115200);
             QThread::msleep(25);
             writeMessage(m);
-            while (serialLink->port()->bytesToWrite()) {
-                // We are not changing the connection structure, only waiting for bytes to be written
-                const_cast<QSerialPort*>(serialLink->port())->waitForBytesWritten();
-            }
+            serialLink->waitForBytesWritten();
         }
     }
 
     // Wait for bytes to be written before finishing the connection
-    while (serialLink->port()->bytesToWrite()) {
-        qCDebug(PING_PROTOCOL_PING360) << "Waiting for bytes to be written...";
-        // We are not changing the connection structure, only waiting for bytes to be written
-        const_cast<QSerialPort*>(serialLink->port())->waitForBytesWritten();
-        qCDebug(PING_PROTOCOL_PING360) << "Done !";
-    }
+    qCDebug(PING_PROTOCOL_PING360) << "Waiting for bytes to be written...";
+    serialLink->waitForBytesWritten();
+    qCDebug(PING_PROTOCOL_PING360) << "Done !";
 
     qCDebug(PING_PROTOCOL_PING360) << "Finish connection.";
     auto flashSensor = [=] {
@@ -618,7 +622,7 @@ void Ping360::flash(const QString& fileUrl, bool sendPingGotoBootloader, int bau
     };
 
     auto finishConnection = [=] {
-        link()->finishConnection();
+        finishLinkConnection();
 
         qCDebug(PING_PROTOCOL_PING360) << "Save sensor configuration.";
         updateSensorConfigurationSettings();
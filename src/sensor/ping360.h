@@ -224,11 +224,12 @@ public:
     Q_PROPERTY(int gain_setting READ gain_setting WRITE set_gain_setting NOTIFY gainSettingChanged)
 
     /**
-     * @brief Return last array of points
+     * @brief Return the last profile normalized to [0-1]
+     *  It's calculated for each call, profile should be used when possible
      *
      * @return QVector<double>
      */
-    QVector<double> data() { return _data; }
+    QVector<double> data() const { return normalizedSamples(_profile.samples()); }
     Q_PROPERTY(QVector<double> data READ data NOTIFY dataChanged)
 
     /**
@@ -665,7 +666,6 @@ private:
 
     // This variables are not user configuration settings
     uint16_t _angle = 200;
-    QVector<double> _data;
     ///@}
 
     /**
@@ -784,6 +784,15 @@ private:
 
     void handleMessage(const ping_message& msg) final; // handle incoming message
 
+    /**
+     * @brief Create the profile of a device data message
+     *
+     * @param samples
+     * @param length number of samples
+     * @param gain
+     */
+    void updateProfile(const uint8_t* samples, int length, int gain);
+
     void loadLastSensorConfigurationSettings();
     void updateSensorConfigurationSettings();
     void setLastSensorConfiguration();
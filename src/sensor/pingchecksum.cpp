@@ -0,0 +1,102 @@
+#include <QtEndian>
+
+#include "ping-message.h"
+#include "pingchecksum.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__)
+#define PING_CHECKSUM_SSE2
+#include <emmintrin.h>
+#endif
+
+// AVX2 is selected in runtime when the compiler allows us to build it without enabling it for the entire project
+#if defined(PING_CHECKSUM_SSE2) && (defined(__AVX2__) || defined(__GNUC__))
+#define PING_CHECKSUM_AVX2
+#include <immintrin.h>
+#ifdef __AVX2__
+#define PING_CHECKSUM_AVX2_TARGET
+#else
+#define PING_CHECKSUM_AVX2_TARGET __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace {
+
+uint32_t sumScalar(const uint8_t* data, int length)
+{
+    uint32_t sum = 0;
+    for (int i = 0; i < length; i++) {
+        sum += data[i];
+    }
+    return sum;
+}
+
+#ifdef PING_CHECKSUM_SSE2
+uint32_t sumSse2(const uint8_t* data, int length)
+{
+    // The sum of absolute differences with zero adds 8 bytes in each 64 bits lane
+    const __m128i zero = _mm_setzero_si128();
+    __m128i sum = zero;
+    int i = 0;
+    for (; i + 16 <= length; i += 16) {
+        const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        sum = _mm_add_epi64(sum, _mm_sad_epu8(bytes, zero));
+    }
+    sum = _mm_add_epi64(sum, _mm_srli_si128(sum, 8));
+    return static_cast<uint32_t>(_mm_cvtsi128_si32(sum)) + sumScalar(data + i, length - i);
+}
+#endif
+
+#ifdef PING_CHECKSUM_AVX2
+PING_CHECKSUM_AVX2_TARGET uint32_t sumAvx2(const uint8_t* data, int length)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i sum = zero;
+    int i = 0;
+    for (; i + 32 <= length; i += 32) {
+        const __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        sum = _mm256_add_epi64(sum, _mm256_sad_epu8(bytes, zero));
+    }
+    __m128i half = _mm_add_epi64(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+    half = _mm_add_epi64(half, _mm_srli_si128(half, 8));
+    return static_cast<uint32_t>(_mm_cvtsi128_si32(half)) + sumScalar(data + i, length - i);
+}
+
+bool hasAvx2()
+{
+#ifdef __AVX2__
+    return true;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif
+
+using SumFunction = uint32_t (*)(const uint8_t*, int);
+
+SumFunction bestSumFunction()
+{
+#ifdef PING_CHECKSUM_AVX2
+    if (hasAvx2()) {
+        return sumAvx2;
+    }
+#endif
+#ifdef PING_CHECKSUM_SSE2
+    return sumSse2;
+#else
+    return sumScalar;
+#endif
+}
+
+}
+
+uint16_t PingChecksum::calculate(const uint8_t* data, int length)
+{
+    static const SumFunction sum = bestSumFunction();
+    return static_cast<uint16_t>(sum(data, length));
+}
+
+void PingChecksum::update(ping_message& message)
+{
+    const int checksumPosition = static_cast<int>(message.msgDataLength()) - ping_message::checksumLength;
+    qToLittleEndian<uint16_t>(calculate(message.msgData, checksumPosition), message.msgData + checksumPosition);
+}
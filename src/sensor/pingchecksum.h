@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+
+class ping_message;
+
+/**
+ * @brief Ping protocol checksum, the sum of all message bytes before the checksum field
+ *  The sum is vectorized with SSE2 or AVX2 when available, with a scalar fallback for other architectures.
+ */
+namespace PingChecksum {
+
+/**
+ * @brief Calculate the checksum of a buffer
+ *
+ * @param data
+ * @param length
+ * @return uint16_t
+ */
+uint16_t calculate(const uint8_t* data, int length);
+
+/**
+ * @brief Calculate and write the checksum of a message, same as ping_message::updateChecksum
+ *
+ * @param message
+ */
+void update(ping_message& message);
+
+}
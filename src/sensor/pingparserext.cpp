@@ -1,20 +1,81 @@
+#include <cstring>
+#include <utility>
+
+#include <QtEndian>
+
+#include "pingchecksum.h"
 #include "pingparserext.h"
 
-void PingParserExt::clearBuffer() { _parser.reset(); }
+void PingParserExt::clearBuffer()
+{
+    _buffer.clear();
+    _parser.reset();
+}
 
-void PingParserExt::parseBuffer(const QByteArray& data)
+int PingParserExt::parseMessages(const uint8_t* data, int length)
 {
-    for (int i = 0; i < data.length(); i++) {
-        PingParser::State state = _parser.parseByte(data.at(i));
-        if (state == PingParser::State::NEW_MESSAGE) {
-            parsed++;
-            _rxMessage = _parser.rxMessage;
-            emit newMessage(_rxMessage);
-        } else if (state == PingParser::State::ERROR) {
+    int position = 0;
+    while (position < length) {
+        // Look for the 'BR' sync
+        const auto sync = static_cast<const uint8_t*>(memchr(data + position, 'B', length - position));
+        if (!sync) {
+            return length;
+        }
+        position = sync - data;
+
+        // Wait for the header to check the message length
+        if (length - position < ping_message::headerLength) {
+            return position;
+        }
+        if (sync[1] != 'R') {
+            position++;
+            continue;
+        }
+
+        const int payloadLength = qFromLittleEndian<uint16_t>(sync + 2);
+        const int messageLength = ping_message::headerLength + payloadLength + ping_message::checksumLength;
+        if (messageLength > _maxMessageLength) {
             errors++;
             emit parseError();
+            position++;
+            continue;
+        }
+        if (length - position < messageLength) {
+            return position;
         }
+
+        const int checksumPosition = messageLength - ping_message::checksumLength;
+        if (PingChecksum::calculate(sync, checksumPosition) != qFromLittleEndian<uint16_t>(sync + checksumPosition)) {
+            errors++;
+            emit parseError();
+            position++;
+            continue;
+        }
+
+        parsed++;
+        const PingMessageView message(sync);
+        emit newMessage(message);
+        position += messageLength;
     }
+    return position;
+}
+
+void PingParserExt::parseBuffer(const QByteArray& data)
+{
+    const auto bytes = reinterpret_cast<const uint8_t*>(data.constData());
+
+    // Messages are parsed directly from the received data, only incomplete messages are copied
+    if (_buffer.isEmpty()) {
+        const int processed = parseMessages(bytes, data.size());
+        _buffer = data.mid(processed);
+        return;
+    }
+
+    // The buffer can be cleared by a newMessage receiver, it should not be used while parsed
+    QByteArray buffer = std::move(_buffer);
+    buffer.append(data);
+    const int processed = parseMessages(reinterpret_cast<const uint8_t*>(buffer.constData()), buffer.size());
+    _buffer = buffer.mid(processed);
 }
 
 Parser::ParserState PingParserExt::parseByte(const char byte)
@@ -1,8 +1,37 @@
 #pragma once
 
+#include <QByteArray>
+
 #include "parser.h"
 #include "ping-parser.h"
 
+/**
+ * @brief Ping message that points to data owned by someone else
+ *  It's used to hand out parsed messages without copying them, the data must outlive the view.
+ *  Copies of the view are normal messages that own their data.
+ */
+class PingMessageView : public ping_message {
+public:
+    /**
+     * @brief Construct a view of a complete ping message
+     *
+     * @param data message data, starting with the 'BR' header
+     */
+    explicit PingMessageView(const uint8_t* data)
+        : ping_message()
+    {
+        msgData = const_cast<uint8_t*>(data);
+    }
+
+    /**
+     * @brief The data is not owned by the view and should not be deleted by ping_message
+     */
+    ~PingMessageView() { msgData = nullptr; }
+
+private:
+    Q_DISABLE_COPY(PingMessageView)
+};
+
 /**
  * @brief The PingParserExt class wraps the PingParser class from the ping-protocol submodule
  * and Extends it with signalling in order to subclass our Parser class
@@ -13,7 +42,7 @@ public:
      * @brief Any messages parsed must be shorter than the buffer length
      */
     PingParserExt()
-        : _parser(10240)
+        : _parser(_maxMessageLength)
     {
     }
 
@@ -24,6 +53,9 @@ public:
 
     /**
      * @brief asynchronous use, Child classes should signal when something happens ie. 'emit newMessage(Message m)'
+     *  The buffer is scanned for complete messages that are emitted as views of the received data, the messages are
+     *  only valid during the signal emission. Incomplete messages are kept until the next call.
+     *  rxMessage is not updated by this function.
      * @param data the next sequence of bytes in the serial stream being parsed
      */
     void parseBuffer(const QByteArray& data) override final;
@@ -36,5 +68,18 @@ public:
     ParserState parseByte(const char byte) override final;
 
 private:
+    /**
+     * @brief Emit all complete messages of a buffer
+     *
+     * @param data
+     * @param length
+     * @return int number of bytes processed, the remaining bytes are part of an incomplete message
+     */
+    int parseMessages(const uint8_t* data, int length);
+
+    static constexpr int _maxMessageLength = 10240;
+
+    // Incomplete message received in the last parseBuffer call
+    QByteArray _buffer;
     PingParser _parser;
 };
@@ -5,13 +5,72 @@
 
 PING_LOGGING_CATEGORY(PING_PROTOCOL_PINGSENSOR, "ping.protocol.pingsensor")
 
+// Profiles parsed by the link thread and not handled yet before new profiles are dropped
+// It limits the events of a single sensor in the queue of the sensor thread, so the other sensors are not delayed
+const int maximumPendingProfiles = 32;
+
 PingSensor::PingSensor(PingDeviceType pingDeviceType)
     : Sensor({SensorFamily::PING, {static_cast<int>(pingDeviceType)}})
 {
     _parser = new PingParserExt();
-    connect(dynamic_cast<PingParserExt*>(_parser), &PingParserExt::newMessage, this, &PingSensor::handleMessagePrivate,
+    connect(dynamic_cast<PingParserExt*>(_parser), &PingParserExt::newMessage, this, &PingSensor::receiveMessage,
+        Qt::DirectConnection);
+    connect(dynamic_cast<PingParserExt*>(_parser), &PingParserExt::parseError, this, &PingSensor::receiveParseError,
         Qt::DirectConnection);
-    connect(dynamic_cast<PingParserExt*>(_parser), &PingParserExt::parseError, this, &PingSensor::parserErrorsChanged);
+}
+
+void PingSensor::receiveMessage(const ping_message& msg)
+{
+    // Logs are parsed by the sensor thread
+    if (QThread::currentThread() == thread()) {
+        handleMessagePrivate(msg);
+        return;
+    }
+
+    // Only profiles that are superseded by the next ones can be dropped, the other messages are always handled
+    const bool superseded = _supersededMessages.contains(msg.message_id());
+    if (superseded) {
+        if (_pendingProfiles >= maximumPendingProfiles) {
+            // Avoid a warning for each profile when the sensor thread can't keep up
+            if (_droppedMessages++ % 100 == 0) {
+                qCWarning(PING_PROTOCOL_PINGSENSOR)
+                    << "Profiles are received faster than handled, profiles dropped:" << _droppedMessages;
+            }
+            return;
+        }
+        _pendingProfiles++;
+    }
+
+    // The message is a view of the received data, the copy owns its data
+    QMetaObject::invokeMethod(
+        this,
+        [this, superseded, message = ping_message(msg)] {
+            if (superseded) {
+                _pendingProfiles--;
+            }
+            handleMessagePrivate(message);
+        },
+        Qt::QueuedConnection);
+}
+
+void PingSensor::receiveParseError()
+{
+    if (QThread::currentThread() == thread()) {
+        emit parserErrorsChanged();
+        return;
+    }
+
+    // Errors of a noisy link are notified once for each event of the sensor thread
+    if (_parserErrorsPending.exchange(true)) {
+        return;
+    }
+    QMetaObject::invokeMethod(
+        this,
+        [this] {
+            _parserErrorsPending = false;
+            emit parserErrorsChanged();
+        },
+        Qt::QueuedConnection);
 }
 
 void PingSensor::request(int id) const
@@ -36,6 +95,16 @@ void PingSensor::writeMessage(const ping_message& msg) const
     }
 }
 
+QVector<double> PingSensor::normalizedSamples(const QByteArray& samples)
+{
+    QVector<double> points(samples.size());
+    const auto data = reinterpret_cast<const uint8_t*>(samples.constData());
+    for (int i = 0; i < samples.size(); i++) {
+        points[i] = data[i] / 255.0;
+    }
+    return points;
+}
+
 void PingSensor::handleMessagePrivate(const ping_message& msg)
 {
     qCDebug(PING_PROTOCOL_PINGSENSOR) << QStringLiteral("Handling Message: %1 [%2]")
@@ -158,7 +227,14 @@ void PingSensor::printStatus() const
     qCDebug(PING_PROTOCOL_PINGSENSOR) << "\t- ascii_text:" << _commonVariables.ascii_text;
     qCDebug(PING_PROTOCOL_PINGSENSOR) << "\t- nack_msg:" << _commonVariables.nack_msg;
     qCDebug(PING_PROTOCOL_PINGSENSOR) << "\t- lostMessages:" << _lostMessages;
+    qCDebug(PING_PROTOCOL_PINGSENSOR) << "\t- droppedMessages:" << _droppedMessages;
     printSensorInformation();
 }
 
-PingSensor::~PingSensor() = default;
+PingSensor::~PingSensor()
+{
+    // The link thread should not deliver messages to the members of this class while they are destroyed
+    if (link()) {
+        finishLinkConnection();
+    }
+}
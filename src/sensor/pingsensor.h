@@ -1,5 +1,8 @@
 #pragma once
 
+#include <atomic>
+
+#include "profile.h"
 #include "sensor.h"
 
 /**
@@ -131,6 +134,14 @@ public:
     int lostMessages() { return _lostMessages; }
     Q_PROPERTY(int lost_messages READ lostMessages NOTIFY lostMessagesChanged)
 
+    /**
+     * @brief Return the last profile received from the sensor
+     *
+     * @return Profile
+     */
+    Profile profile() const { return _profile; }
+    Q_PROPERTY(Profile profile READ profile NOTIFY profileChanged)
+
     /**
      * @brief Request message id
      *
@@ -162,6 +173,7 @@ signals:
     void nackMsgChanged();
     void parsedMsgsChanged();
     void parserErrorsChanged();
+    void profileChanged(const Profile& profile);
     void protocolVersionMajorChanged();
     void protocolVersionMinorChanged();
     void protocolVersionPatchChanged();
@@ -195,6 +207,14 @@ protected:
      */
     void writeMessage(const ping_message& msg) const;
 
+    /**
+     * @brief Return the samples of a profile normalized to [0-1], where 1 is the maximum power
+     *
+     * @param samples
+     * @return QVector<double>
+     */
+    static QVector<double> normalizedSamples(const QByteArray& samples);
+
     // Common variables between all ping devices
     struct CommonVariables {
         QString ascii_text;
@@ -223,7 +243,40 @@ protected:
     } _commonVariables;
 
     int _lostMessages {0};
+    // Last profile received, it's shared with the interface and should not be modified
+    Profile _profile;
+
+    /**
+     * @brief Set the profile messages that are superseded by the next ones
+     *  They are dropped when the sensor thread can't handle the messages of the link thread, all other messages are
+     *  always handled. It should be called by the constructor, before the link is connected.
+     *
+     * @param messageIds
+     */
+    void setSupersededMessages(const QVector<int>& messageIds) { _supersededMessages = messageIds; }
 
 private:
     Q_DISABLE_COPY(PingSensor)
+
+    /**
+     * @brief Receive a message from the parser, in the link thread or in the sensor thread for logs
+     *  Messages of the link thread are copied and handled by the sensor thread, superseded profiles are dropped when
+     *  too many are pending.
+     *
+     * @param msg view of the received data, only valid during this call
+     */
+    void receiveMessage(const ping_message& msg);
+
+    /**
+     * @brief Receive a parser error, in the link thread or in the sensor thread for logs
+     *
+     */
+    void receiveParseError();
+
+    // Updated by the link thread
+    std::atomic<int> _droppedMessages {0};
+    std::atomic<bool> _parserErrorsPending {false};
+    std::atomic<int> _pendingProfiles {0};
+    // Only changed before the link is connected, read by the link thread
+    QVector<int> _supersededMessages;
 };
@@ -0,0 +1,18 @@
+#include "profile.h"
+
+const Profile::Data Profile::_invalidData;
+
+QDebug operator<<(QDebug d, const Profile& profile)
+{
+    QDebugStateSaver saver(d);
+    if (!profile.isValid()) {
+        d.nospace() << "Profile(invalid)";
+        return d;
+    }
+
+    d.nospace() << "Profile(ping: " << profile.pingNumber() << ", samples: " << profile.samples().size()
+                << ", angle: " << profile.angle() << ", initial point: " << profile.initialPoint()
+                << ", length: " << profile.length() << ", gain: " << profile.gain()
+                << ", timestamp: " << profile.timestampMs() << ")";
+    return d;
+}
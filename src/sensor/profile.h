@@ -0,0 +1,93 @@
+#pragma once
+
+#include <QByteArray>
+#include <QDebug>
+#include <QMetaType>
+#include <QSharedPointer>
+
+#include <utility>
+
+/**
+ * @brief Immutable sensor profile
+ *  The profile is shared between the sensor, QML and the plots, copies only increment a reference counter.
+ *  Values that are not provided by the sensor are zero (E.g: angle for Ping1D, distance for Ping360)
+ */
+class Profile {
+    Q_GADGET
+    Q_PROPERTY(float angle READ angle CONSTANT)
+    Q_PROPERTY(float confidence READ confidence CONSTANT)
+    Q_PROPERTY(float distance READ distance CONSTANT)
+    Q_PROPERTY(int gain READ gain CONSTANT)
+    Q_PROPERTY(float initialPoint READ initialPoint CONSTANT)
+    Q_PROPERTY(bool isValid READ isValid CONSTANT)
+    Q_PROPERTY(float length READ length CONSTANT)
+    Q_PROPERTY(uint pingNumber READ pingNumber CONSTANT)
+    Q_PROPERTY(QByteArray samples READ samples CONSTANT)
+    Q_PROPERTY(qint64 timestampMs READ timestampMs CONSTANT)
+
+public:
+    /**
+     * @brief Profile information
+     *
+     */
+    struct Data {
+        // Angle of the profile in gradians
+        float angle = 0;
+        // Confidence of the distance in percent
+        float confidence = 0;
+        // Distance of the detected target in meters
+        float distance = 0;
+        int gain = 0;
+        // Distance of the first sample in meters
+        float initialPoint = 0;
+        // Distance between the first and last sample in meters
+        float length = 0;
+        uint pingNumber = 0;
+        // One byte per sample, where 255 is the maximum power
+        QByteArray samples;
+        // Reception time in ms since epoch
+        qint64 timestampMs = 0;
+    };
+
+    /**
+     * @brief Construct an invalid profile
+     *
+     */
+    Profile() = default;
+
+    /**
+     * @brief Construct a new Profile object
+     *
+     * @param data
+     */
+    explicit Profile(Data data)
+        : _data(QSharedPointer<const Data>::create(std::move(data)))
+    {
+    }
+
+    float angle() const { return data().angle; }
+    float confidence() const { return data().confidence; }
+    float distance() const { return data().distance; }
+    int gain() const { return data().gain; }
+    float initialPoint() const { return data().initialPoint; }
+    bool isValid() const { return !_data.isNull(); }
+    float length() const { return data().length; }
+    uint pingNumber() const { return data().pingNumber; }
+    const QByteArray& samples() const { return data().samples; }
+    qint64 timestampMs() const { return data().timestampMs; }
+
+    /**
+     * @brief Return the profile information
+     *
+     * @return const Data&
+     */
+    const Data& data() const { return _data ? *_data : _invalidData; }
+
+private:
+    QSharedPointer<const Data> _data;
+    static const Data _invalidData;
+};
+
+Q_DECLARE_METATYPE(Profile)
+
+QDebug operator<<(QDebug d, const Profile& profile);
@@ -22,6 +22,8 @@ Sensor::Sensor(SensorInfo sensorInfo)
     , _parser(nullptr)
     , _sensorInfo(sensorInfo)
 {
+    _linkThread.setObjectName(QStringLiteral("SensorLink"));
+
     connect(this, &Sensor::connectionOpen, this, [this] {
         _connected = true;
         emit connectionChanged();
@@ -36,7 +38,7 @@ Sensor::Sensor(SensorInfo sensorInfo)
 void Sensor::connectLink(const LinkConfiguration conConf, const LinkConfiguration& logConf)
 {
     if (link()->isOpen()) {
-        link()->finishConnection();
+        finishLinkConnection();
     }
 
     qCDebug(PING_PROTOCOL_SENSOR) << "Connecting to" << conConf;
@@ -45,9 +47,15 @@ void Sensor::connectLink(const LinkConfiguration conConf, const LinkConfiguratio
         return;
     }
     if (link()) {
-        _linkIn.clear();
+        releaseLink();
     }
     _linkIn = QSharedPointer<Link>(new Link(conConf));
+
+    // Logs are played by their own thread and are controlled by the user interface
+    if (link()->type() != LinkType::File) {
+        _linkThread.start();
+        link()->moveIoToThread(&_linkThread);
+    }
     link()->startConnection();
 
     if (!link()->isOpen()) {
@@ -73,8 +81,7 @@ void Sensor::connectLink(const LinkConfiguration conConf, const LinkConfiguratio
         }
 
         if (linkLog()->isOpen()) {
-            linkLog()->finishConnection();
-            _linkOut.clear();
+            releaseLinkLog();
         }
     } else {
         if (!logConf.isValid()) {
@@ -93,7 +100,7 @@ void Sensor::connectLinkLog(const LinkConfiguration& logConf)
             qCCritical(PING_PROTOCOL_SENSOR) << "No connection to log !" << linkLog()->errorString();
             return;
         }
-        _linkOut.clear();
+        releaseLinkLog();
     }
 
     if (!logConf.isValid()) {
@@ -116,10 +123,42 @@ void Sensor::connectLinkLog(const LinkConfiguration& logConf)
         return;
     }
 
-    connect(link(), &AbstractLink::newData, linkLog(), &AbstractLink::sendData);
+    // The log is written by the thread that receives the data
+    connect(link(), &AbstractLink::newData, linkLog(), &AbstractLink::sendData, Qt::DirectConnection);
     emit linkLogChanged();
 }
 
+void Sensor::finishLinkConnection()
+{
+    // The connections are removed by the link thread, no data can be in use when it returns
+    link()->callInIoThread([this] {
+        if (_parser) {
+            link()->disconnect(_parser);
+        }
+        if (linkLog()) {
+            link()->disconnect(linkLog());
+        }
+    });
+    link()->finishConnection();
+}
+
+void Sensor::releaseLink()
+{
+    // The io objects are destroyed with the link, they can't belong to the running link thread
+    link()->moveIoToThread(link()->thread());
+    _linkIn.clear();
+}
+
+void Sensor::releaseLinkLog()
+{
+    // The log is written by the link thread, the connection is removed by it before the log is closed
+    if (link()) {
+        link()->callInIoThread([this] { link()->disconnect(linkLog()); });
+    }
+    linkLog()->finishConnection();
+    _linkOut.clear();
+}
+
 void Sensor::setControlPanel(const QUrl& url)
 {
     if (!url.isValid()) {
@@ -229,4 +268,13 @@ void Sensor::setName(const QString& name)
     emit nameChanged();
 }
 
-Sensor::~Sensor() = default;
+Sensor::~Sensor()
+{
+    // The entry link is closed and released before the link thread finishes
+    if (link()) {
+        finishLinkConnection();
+        releaseLink();
+    }
+    _linkThread.quit();
+    _linkThread.wait();
+}
@@ -3,6 +3,7 @@
 #include <QPointer>
 #include <QQmlComponent>
 #include <QQuickItem>
+#include <QThread>
 
 #include "flasher.h"
 #include "link.h"
@@ -13,7 +14,8 @@
 
 /**
  * @brief Manage sensor connection
- *
+ *  Each sensor has a link thread, where the data of serial, network and simulation links is received, parsed and
+ *  logged. The messages are handled by the sensor thread, a slow or noisy sensor does not delay the others.
  */
 class Sensor : public QObject {
     Q_OBJECT
@@ -25,6 +27,11 @@ public:
      * @param sensorInfo
      */
     Sensor(SensorInfo sensorInfo);
+
+    /**
+     * @brief Destroy the Sensor object, the link thread is finished after the links are closed
+     *
+     */
     ~Sensor();
 
     /**
@@ -193,6 +200,13 @@ protected:
      */
     void setName(const QString& name);
 
+    /**
+     * @brief Finish the connection of the entry link, its data is no longer parsed or logged
+     *  When it returns, the link thread does not use the parser or the log link.
+     *
+     */
+    void finishLinkConnection();
+
 signals:
     void autoDetectUpdate(bool autodetect);
 
@@ -209,4 +223,20 @@ signals:
 
 private:
     Q_DISABLE_COPY(Sensor)
+
+    /**
+     * @brief Release the entry link, its io objects are moved back to the sensor thread to be destroyed
+     *  The link should be closed before
+     *
+     */
+    void releaseLink();
+
+    /**
+     * @brief Disconnect the log from the entry link in the link thread, then close and release it
+     *
+     */
+    void releaseLinkLog();
+
+    // Receive, parse and log the data of the entry link, it's started by the first link that is not a log file
+    QThread _linkThread;
 };
@@ -124,9 +124,12 @@ private:
     AUTO_PROPERTY(bool, logScrollLock, true)
     AUTO_PROPERTY(bool, realTimeReplay, true)
     AUTO_PROPERTY(bool, replayMenu, false)
+    // Multiplier of the log time, 0 plays logs as fast as possible
+    AUTO_PROPERTY(double, replaySpeed, 1)
     AUTO_PROPERTY(bool, reset, false)
     AUTO_PROPERTY(bool, darkTheme, false)
     AUTO_PROPERTY(bool, enableSensorAdvancedConfiguration, false)
+    AUTO_PROPERTY(bool, compressSensorLog, false)
     // AUTO_PROPERTY_MODEL(QString, adistanceUnits, QStringList, MODEL({"Metric", "Imperial"})) // Example
     AUTO_PROPERTY_JSONMODEL(distanceUnits, QByteArrayLiteral(R"({
             "settings": [
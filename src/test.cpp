@@ -1,26 +1,86 @@
 #define private public
 #define protected public
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
 #include <QApplication>
 #include <QDebug>
 #include <QQmlApplicationEngine>
 #include <QQmlContext>
 #include <QQmlEngine>
+#include <QQuickWindow>
 #include <QQuickStyle>
 #include <QRegularExpression>
 
 #include "abstractlink.h"
+#include "asynclogwriter.h"
+#include "batchrenderer.h"
+#include "decimation.h"
+#include "filelink.h"
 #include "filemanager.h"
 #include "linkconfiguration.h"
+#include "logcatalog.h"
 #include "logger.h"
+#include "logindex.h"
+#include "logkeyframes.h"
+#include "maxsegmenttree.h"
 #include "ping.h"
+#include "pingchecksum.h"
+#include "pingparserext.h"
+#include "polarplot.h"
+#include "processlog.h"
+#include "profile.h"
+#include "replayscheduler.h"
 #include "settingsmanager.h"
+#include "slidingwindowextremum.h"
 #include "util.h"
 #include "waterfall.h"
+#include "waterfallplot.h"
+#include "waterfallrenderer.h"
 
 #include "test.h"
 
 #include "ping-message-ping1d.h"
+#include "ping-message-ping360.h"
+
+namespace {
+/**
+ * @brief Simulated Ping360 profiles, low intensity noise with a single echo, like Ping360SimulationLink
+ *
+ * @param numberOfMessages
+ * @param numberOfSamples
+ * @return QVector<QByteArray> device data messages
+ */
+QVector<QByteArray> simulatedPing360Messages(int numberOfMessages, int numberOfSamples)
+{
+    QRandomGenerator random(42);
+    QVector<QByteArray> messages;
+    ping360_device_data deviceData(numberOfSamples);
+    for (int counter = 0; counter < numberOfMessages; counter++) {
+        const float stop1 = numberOfSamples / 2.0 - 10 * qSin(counter / 10.0);
+        const float stop2 = 3 * numberOfSamples / 5.0 + 6 * qCos(counter / 5.5);
+        deviceData.set_angle(counter % 400);
+        deviceData.set_number_of_samples(numberOfSamples);
+        deviceData.set_data_length(numberOfSamples);
+        for (int i = 0; i < numberOfSamples; i++) {
+            float point;
+            if (i < stop1) {
+                point = 0.1 * random.bounded(256);
+            } else if (i < stop2) {
+                point = 255 * ((-4.0 / qPow(stop2 - stop1, 2.0)) * qPow(i - stop1 - (stop2 - stop1) / 2.0, 2.0) + 1.0);
+            } else {
+                point = 0.45 * random.bounded(256);
+            }
+            deviceData.set_data_at(i, point);
+        }
+        deviceData.updateChecksum();
+        messages.append(QByteArray(reinterpret_cast<const char*>(deviceData.msgData), deviceData.msgDataLength()));
+    }
+    return messages;
+}
+}
 
 void Test::initTestCase()
 {
@@ -29,6 +89,89 @@ void Test::initTestCase()
     SettingsManager::self();
 }
 
+void Test::batchRenderer()
+{
+    QTemporaryDir dir;
+    QVERIFY2(dir.isValid(), qPrintable("Temporary folder is not valid."));
+    for (const auto& folder : {"first", "second", "invalid"}) {
+        QVERIFY(QDir(dir.path()).mkdir(folder));
+    }
+
+    const auto writeLog = [](const QString& fileName, PingDeviceType deviceType, const QVector<QByteArray>& packets) {
+        LogSensorStruct logSensorStruct;
+        logSensorStruct.setSensorInfo({SensorFamily::PING, {static_cast<int>(deviceType)}});
+        AsyncLogWriter writer;
+        if (!writer.open(fileName, logSensorStruct, false)) {
+            return false;
+        }
+        for (int i = 0; i < packets.size(); i++) {
+            writer.write(packets[i], i * 50000ull);
+        }
+        writer.close();
+        return true;
+    };
+
+    // Logs with the same name in different folders should not overwrite the image of each other
+    const QVector<QByteArray> packets = simulatedPing360Messages(100, 1200);
+    QVERIFY(writeLog(dir.filePath("first/scan.bin"), PingDeviceType::PING360, packets));
+    QVERIFY(writeLog(dir.filePath("second/scan.bin"), PingDeviceType::PING360, packets));
+    BatchRenderer renderer({dir.filePath("first"), dir.filePath("second")});
+    renderer.setOutputFolder(dir.path());
+    QCOMPARE(renderer.exec(), 0);
+    for (const auto& imageName : {"scan.png", "scan_2.png"}) {
+        const QImage image(dir.filePath(imageName));
+        QVERIFY2(!image.isNull(), qPrintable(QString("Image was not saved: %1").arg(imageName)));
+        bool drawn = false;
+        for (int y = 0; y < image.height() && !drawn; y++) {
+            for (int x = 0; x < image.width() && !drawn; x++) {
+                drawn = qAlpha(image.pixel(x, y)) != 0;
+            }
+        }
+        QVERIFY2(drawn, qPrintable(QString("Image is empty: %1").arg(imageName)));
+    }
+
+    // Logs without a valid sensor type or without profiles are failures and have no image
+    QVERIFY(writeLog(dir.filePath("invalid/unknown.bin"), PingDeviceType::UNKNOWN, packets));
+    QVERIFY(writeLog(dir.filePath("invalid/empty.bin"), PingDeviceType::PING360, {}));
+    BatchRenderer invalidRenderer({dir.filePath("invalid")});
+    invalidRenderer.setOutputFolder(dir.path());
+    QCOMPARE(invalidRenderer.exec(), 1);
+    QCOMPARE(invalidRenderer._failures, 2);
+    QVERIFY(!QFile::exists(dir.filePath("unknown.png")));
+    QVERIFY(!QFile::exists(dir.filePath("empty.png")));
+}
+
+void Test::decimation()
+{
+    QRandomGenerator random(42);
+    for (int i = 0; i < 200; i++) {
+        const int length = 1 + random.bounded(5000);
+        const int outputLength = 1 + random.bounded(2000);
+        QVector<uint8_t> samples(length);
+        for (auto& sample : samples) {
+            sample = random.bounded(256);
+        }
+
+        QVector<uint8_t> resampled(outputLength);
+        QVector<uint8_t> minimum(outputLength);
+        QVector<uint8_t> maximum(outputLength);
+        Decimation::resampleMax(samples.constData(), length, resampled.data(), outputLength);
+        Decimation::minMax(samples.constData(), length, minimum.data(), maximum.data(), outputLength);
+
+        // Each output should be the extreme of its range, or the nearest sample when upsampling
+        for (int output = 0; output < outputLength; output++) {
+            const int start = static_cast<qint64>(output) * length / outputLength;
+            const int rangeEnd = static_cast<qint64>(output + 1) * length / outputLength;
+            const int end = std::max(start + 1, rangeEnd);
+            const auto range = std::minmax_element(samples.cbegin() + start, samples.cbegin() + end);
+            QVERIFY2(resampled[output] == *range.second && maximum[output] == *range.second
+                    && minimum[output] == *range.first,
+                qPrintable(
+                    QString("Wrong decimation of %1 samples to %2: %3").arg(length).arg(outputLength).arg(output)));
+        }
+    }
+}
+
 void Test::fileManager()
 {
     auto fileManager = FileManager::self();
@@ -72,6 +215,58 @@ void Test::fileManager()
     // TODO: Populate gradients folder and test FileManager.getFilesFrom
 }
 
+void Test::logCatalog()
+{
+    QTemporaryDir dir;
+    QVERIFY2(dir.isValid(), qPrintable("Temporary folder is not valid."));
+    const QString fileName = dir.filePath(QStringLiteral("log.bin"));
+
+    const int numberOfPackets = 800;
+    LogSensorStruct logSensorStruct;
+    logSensorStruct.init();
+    AsyncLogWriter writer;
+    QVERIFY2(writer.open(fileName, logSensorStruct, true), qPrintable(writer.errorString()));
+    const QVector<QByteArray> packets = simulatedPing360Messages(numberOfPackets, 1200);
+    for (int i = 0; i < packets.size(); i++) {
+        // 20Hz
+        QVERIFY(writer.write(packets[i], i * 50000ull));
+    }
+    writer.close();
+
+    const LogCatalog::Entry entry = LogCatalog::describe(QFileInfo(fileName));
+    QVERIFY2(entry.ready && entry.valid, qPrintable("Log should be described."));
+    QCOMPARE(entry.packets, numberOfPackets);
+    QCOMPARE(entry.durationMs, (numberOfPackets - 1) * 50ll);
+    QCOMPARE(entry.thumbnail.size(), LogCatalog::thumbnailWidth * LogCatalog::thumbnailHeight);
+    QVERIFY2(entry.thumbnail.count('\0') < entry.thumbnail.size(), qPrintable("Thumbnail should have the profiles."));
+
+    // The log is read in the background the first time, and loaded from the cache after that
+    const QString cacheFileName = dir.filePath(QStringLiteral(".logcatalog"));
+    {
+        LogCatalog catalog(cacheFileName);
+        catalog.setFiles({QFileInfo(fileName)});
+        QTRY_VERIFY(!catalog.scanning());
+        QCOMPARE(catalog.rowCount(), 1);
+        QCOMPARE(catalog.data(catalog.index(0), LogCatalog::Packets).toInt(), numberOfPackets);
+    }
+
+    LogCatalog catalog(cacheFileName);
+    catalog.setFiles({QFileInfo(fileName)});
+    QVERIFY2(!catalog.scanning(), qPrintable("Cached logs should not be read again."));
+    QVERIFY(catalog.data(catalog.index(0), LogCatalog::Ready).toBool());
+    QCOMPARE(catalog.entry(entry.path)->thumbnail, entry.thumbnail);
+
+    // Modified logs are read again
+    QFile logFile(fileName);
+    QVERIFY(logFile.open(QIODevice::Append));
+    logFile.write("more data");
+    logFile.close();
+    catalog.setFiles({QFileInfo(fileName)});
+    QTRY_VERIFY(!catalog.scanning());
+    QCOMPARE(catalog.entry(entry.path)->size, QFileInfo(fileName).size());
+    QVERIFY(catalog.entry(entry.path)->ready);
+}
+
 void Test::logger()
 {
     auto logger = Logger::self();
@@ -83,6 +278,344 @@ void Test::logger()
     QVERIFY2(!logger->isEmpty(), qPrintable("Log file is empty."));
 }
 
+void Test::logIndex()
+{
+    QTemporaryDir dir;
+    QVERIFY2(dir.isValid(), qPrintable("Temporary folder is not valid."));
+    const QString logFileName = dir.filePath(QStringLiteral("log.bin"));
+
+    QFile logFile(logFileName);
+    QVERIFY(logFile.open(QIODevice::WriteOnly));
+    logFile.write(QByteArray(100, 'x'));
+    logFile.close();
+
+    // Sidecar should only be used after the writer is finished
+    LogIndexWriter writer;
+    QVERIFY(writer.open(logFileName));
+    const QVector<LogIndex::Entry> entries = {
+        {10, 1000, 20, LogIndex::noBlock, 1300, LogIndex::noAngle},
+        {34, 1500, 66, 128, 2300, 399},
+    };
+    for (const auto& entry : entries) {
+        writer.append(entry);
+    }
+
+    LogIndex index;
+    QVERIFY2(!index.load(logFileName), qPrintable("Unfinished sidecar index should be invalid."));
+
+    writer.finish();
+    QVERIFY2(index.load(logFileName), qPrintable("Finished sidecar index should be valid."));
+    QCOMPARE(index.size(), entries.size());
+    for (int i = 0; i < entries.size(); i++) {
+        QCOMPARE(index.at(i).offset, entries[i].offset);
+        QCOMPARE(index.at(i).length, entries[i].length);
+        QCOMPARE(index.at(i).blockOffset, entries[i].blockOffset);
+        QCOMPARE(index.at(i).timestampUs, entries[i].timestampUs);
+        QCOMPARE(index.at(i).messageId, entries[i].messageId);
+        QCOMPARE(index.at(i).angle, entries[i].angle);
+    }
+    index.clear();
+
+    // Changes in the log file should invalidate the sidecar index
+    QVERIFY(logFile.open(QIODevice::Append));
+    logFile.write("more data");
+    logFile.close();
+    QVERIFY2(!index.load(logFileName), qPrintable("Sidecar index of a modified log should be invalid."));
+}
+
+void Test::logKeyframes()
+{
+    // Sequential scans with random steps, some packets are not Ping360 data messages
+    QRandomGenerator random(42);
+    QVector<LogIndex::Entry> entries;
+    int angle = 0;
+    for (int i = 0; i < 3 * LogKeyframes::interval + 123; i++) {
+        LogIndex::Entry entry {0, i, 0, LogIndex::noBlock, 0, LogIndex::noAngle};
+        if (random.bounded(10)) {
+            angle = (angle + random.bounded(1, 5)) % LogKeyframes::numberOfAngles;
+            entry.angle = angle;
+        }
+        entries.append(entry);
+    }
+    LogIndex index;
+    index.append(entries);
+
+    // Keyframes are built in steps, like the playback thread
+    LogKeyframes keyframes;
+    for (int count = 0; count < index.size(); count += 777) {
+        keyframes.update(index, count);
+    }
+    keyframes.update(index, index.size());
+    QCOMPARE(keyframes.size(), index.size());
+
+    const QVector<int> packetIndexes = {0, 1, LogKeyframes::interval - 1, LogKeyframes::interval,
+        LogKeyframes::interval + 1, 2 * LogKeyframes::interval + 500, index.size() - 1, index.size()};
+    for (const int packetIndex : packetIndexes) {
+        QVector<int> expected;
+        QVector<int> latest(LogKeyframes::numberOfAngles, -1);
+        for (int i = 0; i < packetIndex; i++) {
+            if (entries[i].angle != LogIndex::noAngle) {
+                latest[entries[i].angle] = i;
+            }
+        }
+        for (const int packet : latest) {
+            if (packet >= 0) {
+                expected.append(packet);
+            }
+        }
+        std::sort(expected.begin(), expected.end());
+
+        QVERIFY2(keyframes.latestPackets(index, packetIndex) == expected,
+            qPrintable(QString("Latest packets do not match before packet: %1").arg(packetIndex)));
+    }
+}
+
+void Test::maxSegmentTree()
+{
+    QRandomGenerator random(42);
+    for (const int size : {1, 2, 7, 400}) {
+        MaxSegmentTree<float> tree(size, 0);
+        QVector<float> values(size, 0);
+        for (int i = 0; i < 2000; i++) {
+            const int index = random.bounded(size);
+            const float value = random.bounded(1000);
+            tree.set(index, value);
+            values[index] = value;
+            const float expected = *std::max_element(values.cbegin(), values.cend());
+            QVERIFY2(tree.max() == expected,
+                qPrintable(QString("Wrong max with size %1: %2 != %3").arg(size).arg(tree.max()).arg(expected)));
+        }
+    }
+}
+
+void Test::pingChecksum()
+{
+    // Random lengths and unaligned positions to check the vectorized loops and their tails
+    QRandomGenerator random(42);
+    QVector<uint8_t> buffer(4096 + 64);
+    for (auto& byte : buffer) {
+        byte = random.bounded(256);
+    }
+
+    // Reference implementation, the byte by byte sum
+    const auto referenceChecksum = [](const uint8_t* data, int length) {
+        uint16_t sum = 0;
+        for (int i = 0; i < length; i++) {
+            sum += data[i];
+        }
+        return sum;
+    };
+
+    for (int i = 0; i < 10000; i++) {
+        const int offset = random.bounded(64);
+        const int length = random.bounded(4096);
+        const uint8_t* data = buffer.constData() + offset;
+        QVERIFY2(PingChecksum::calculate(data, length) == referenceChecksum(data, length),
+            qPrintable(QString("Wrong checksum with offset %1 and length %2").arg(offset).arg(length)));
+    }
+
+    // Same result of ping_message::updateChecksum
+    for (const auto& data : simulatedPing360Messages(10, 1200)) {
+        ping_message message(reinterpret_cast<const uint8_t*>(data.constData()), data.size());
+        message.msgData[message.msgDataLength() - 1] ^= 0xFF;
+        PingChecksum::update(message);
+        QVERIFY(memcmp(message.msgData, data.constData(), data.size()) == 0);
+    }
+}
+
+void Test::pingParser()
+{
+    const int numberOfMessages = 2000;
+    const QVector<QByteArray> messages = simulatedPing360Messages(numberOfMessages, 1200);
+
+    // Stream with noise between messages and a corrupted message, received in chunks like a serial or UDP link
+    QByteArray stream;
+    for (int i = 0; i < messages.size(); i++) {
+        if (i % 100 == 0) {
+            stream.append("Bnoise");
+        }
+        stream.append(messages[i]);
+    }
+    QByteArray corrupted = messages[0];
+    corrupted[ping_message::headerLength] = static_cast<char>(corrupted.at(ping_message::headerLength) ^ 0x01);
+    stream.append(corrupted);
+    const int chunkSize = 1460;
+
+    PingParserExt parser;
+    int received = 0;
+    connect(&parser, &Parser::newMessage, this, [&](const ping_message& message) {
+        const auto& expected = messages[received % numberOfMessages];
+        QCOMPARE(static_cast<int>(message.msgDataLength()), expected.size());
+        QVERIFY(memcmp(message.msgData, expected.constData(), expected.size()) == 0);
+        received++;
+    });
+    for (int i = 0; i < stream.size(); i += chunkSize) {
+        parser.parseBuffer(stream.mid(i, chunkSize));
+    }
+    QCOMPARE(received, numberOfMessages);
+    QCOMPARE(parser.parsed, static_cast<uint32_t>(numberOfMessages));
+    QCOMPARE(parser.errors, 1u);
+    parser.disconnect();
+
+    // The byte by byte state machine finds the same messages
+    int byteMessages = 0;
+    for (const char byte : stream) {
+        byteMessages += parser.parseByte(byte) == Parser::NEW_MESSAGE;
+    }
+    QCOMPARE(byteMessages, numberOfMessages);
+}
+
+void Test::polarPlotDraw()
+{
+    PolarPlot plot;
+    int maxDistanceChanges = 0;
+    connect(&plot, &PolarPlot::maxDistanceChanged, this, [&maxDistanceChanges] { maxDistanceChanges++; });
+
+    // One sample for each column and one row for each gradian
+    const auto createProfile = [&plot](float angle, uint8_t value, float length) {
+        Profile::Data data;
+        data.angle = angle;
+        data.length = length;
+        data.samples = QByteArray(plot.rangeResolution(), static_cast<char>(value));
+        return Profile(std::move(data));
+    };
+    const auto rowValue = [&plot](const QImage& image, int row) -> int {
+        const auto pixels = reinterpret_cast<const uint32_t*>(image.constScanLine(row));
+        if (!std::all_of(pixels, pixels + image.width(), [&pixels](uint32_t pixel) { return pixel == pixels[0]; })) {
+            return -1;
+        }
+        for (int value = 0; value < 256; value++) {
+            if (pixels[0] == plot.valueToRGBA(value / 255.0f)) {
+                return value;
+            }
+        }
+        return pixels[0] == 0 ? 0 : -1;
+    };
+
+    // A burst is drawn in a single render pass, in the received order
+    const QVector<int> angles = {0, 10, 100, 200, 399};
+    for (int i = 0; i < angles.size(); i++) {
+        plot.draw(createProfile(angles[i], 50 + 40 * i, 10 + i), 1, 360);
+    }
+    plot.draw(createProfile(10, 250, 5), 1, 360);
+    QCOMPARE(plot._pendingProfiles.size(), angles.size() + 1);
+
+    plot.grabImage();
+    QImage image = plot._renderer.image();
+    QVERIFY(plot._pendingProfiles.isEmpty());
+    QCOMPARE(maxDistanceChanges, 1);
+    QCOMPARE(plot.maxDistance(), 14.0f);
+    QCOMPARE(rowValue(image, 0), 50);
+    QCOMPARE(rowValue(image, 10), 250);
+    QCOMPARE(rowValue(image, 100), 130);
+    QCOMPARE(rowValue(image, 200), 170);
+    QCOMPARE(rowValue(image, 399), 210);
+    QCOMPARE(image.pixel(0, 50), 0u);
+
+    // The profiles are kept when the render queue is full and coalesced with the next ones
+    plot._renderer.jobMutex()->lock();
+    int queued = 0;
+    while (plot._renderer.tryRender([](QImage&, QRegion&) {})) {
+        queued++;
+    }
+    QVERIFY(queued > 0);
+    plot.draw(createProfile(300, 120, 20), 1, 360);
+    plot.drawPendingProfiles();
+    QCOMPARE(plot._pendingProfiles.size(), 1);
+    QVERIFY(plot._pendingTimer.isActive());
+    QCOMPARE(maxDistanceChanges, 2);
+    plot.draw(createProfile(301, 60, 1), 1, 360);
+    plot._renderer.jobMutex()->unlock();
+
+    QTRY_VERIFY(plot._pendingProfiles.isEmpty());
+    plot.grabImage();
+    image = plot._renderer.image();
+    QCOMPARE(rowValue(image, 300), 120);
+    QCOMPARE(rowValue(image, 301), 60);
+    QCOMPARE(plot.maxDistance(), 20.0f);
+}
+
+void Test::profile()
+{
+    const Profile invalidProfile;
+    QVERIFY(!invalidProfile.isValid());
+    QVERIFY(invalidProfile.samples().isEmpty());
+
+    Profile::Data data;
+    data.angle = 100;
+    data.length = 50;
+    data.samples = QByteArray(1200, 0x7f);
+    const char* samples = data.samples.constData();
+    const Profile profile(std::move(data));
+    QVERIFY(profile.isValid());
+    QCOMPARE(profile.angle(), 100.0f);
+    QCOMPARE(profile.length(), 50.0f);
+
+    // Samples should never be copied, also when the profile goes through QVariant like in QML
+    const Profile copy = profile;
+    QVERIFY(copy.samples().constData() == samples);
+    const Profile variantCopy = QVariant::fromValue(profile).value<Profile>();
+    QVERIFY(variantCopy.samples().constData() == samples);
+}
+
+void Test::replayScheduler()
+{
+    ReplayScheduler scheduler;
+    QElapsedTimer timer;
+    // Generous bound for the delays of a loaded machine, the waits that are checked with it are much longer
+    const qint64 maximumDelayMs = 5000;
+
+    // Packets with 4 ms of log time between them are released each 1 ms in 4x
+    const int numberOfPackets = 100;
+    scheduler.setSpeed(4);
+    timer.start();
+    for (int i = 0; i < numberOfPackets; i++) {
+        QVERIFY(scheduler.wait(i * 4000ll));
+    }
+    const qint64 elapsedUs = timer.nsecsElapsed() / 1000;
+    const qint64 expectedUs = (numberOfPackets - 1) * 1000;
+    QVERIFY2(elapsedUs >= expectedUs, qPrintable(QString("Replay is too fast: %1 us").arg(elapsedUs)));
+    QVERIFY2(elapsedUs < expectedUs + maximumDelayMs * 1000,
+        qPrintable(QString("Replay is too slow: %1 us").arg(elapsedUs)));
+
+    // The first packet restarts the origin, it has no deadline
+    const auto& statistics = scheduler.statistics();
+    QCOMPARE(statistics.packets.load(), static_cast<quint64>(numberOfPackets - 1));
+
+    // Gaps longer than the maximum interval are shortened, the gap has 60 s
+    scheduler.setSpeed(1);
+    scheduler.setMaximumIntervalUs(1000);
+    timer.restart();
+    QVERIFY(scheduler.wait(0));
+    QVERIFY(scheduler.wait(60 * 1000 * 1000ll));
+    QVERIFY2(timer.elapsed() < maximumDelayMs,
+        qPrintable(QString("Gap was not shortened: %1 ms").arg(timer.elapsed())));
+    scheduler.setMaximumIntervalUs(0);
+
+    // Packets are not delayed when playing as fast as possible, the packets have 99 s of log time
+    scheduler.setSpeed(ReplayScheduler::asFastAsPossible);
+    timer.restart();
+    for (int i = 0; i < numberOfPackets; i++) {
+        QVERIFY(scheduler.wait(i * 1000 * 1000ll));
+    }
+    QVERIFY2(timer.elapsed() < maximumDelayMs,
+        qPrintable(QString("Packets were delayed: %1 ms").arg(timer.elapsed())));
+
+    // A resync from other thread interrupts the wait of 60 s
+    scheduler.setSpeed(1);
+    QVERIFY(scheduler.wait(0));
+    QScopedPointer<QThread> thread(QThread::create([&scheduler] {
+        QThread::msleep(20);
+        scheduler.resync();
+    }));
+    thread->start();
+    timer.restart();
+    QVERIFY(!scheduler.wait(60 * 1000 * 1000ll));
+    QVERIFY2(timer.elapsed() < maximumDelayMs,
+        qPrintable(QString("Wait was not interrupted: %1 ms").arg(timer.elapsed())));
+    thread->wait();
+}
+
 void Test::ringVector()
 {
     // Create RingVector
@@ -104,6 +637,128 @@ void Test::ringVector()
     }
 }
 
+void Test::sensorLinkThreads()
+{
+    QTemporaryDir dir;
+    QVERIFY2(dir.isValid(), qPrintable("Temporary folder is not valid."));
+
+    // Ping1DSimulationLink profile interval
+    const int intervalMs = 50;
+    const int numberOfSensors = 2;
+
+    // Each sensor receives, parses and logs the data of its link in its own link thread
+    Ping sensors[numberOfSensors];
+    int profiles[numberOfSensors] = {};
+    for (int i = 0; i < numberOfSensors; i++) {
+        connect(&sensors[i], &PingSensor::profileChanged, this, [&profiles, i] { profiles[i]++; });
+        sensors[i].Sensor::connectLink({LinkType::Ping1DSimulation},
+            {LinkType::File, {dir.filePath(QStringLiteral("sensor%1.bin").arg(i)), QStringLiteral("w")}});
+        QVERIFY(sensors[i].link()->isOpen());
+        QVERIFY(sensors[i].linkLog() && sensors[i].linkLog()->isOpen());
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    QTest::qWait(2000);
+    for (auto& sensor : sensors) {
+        sensor.finishLinkConnection();
+    }
+    const int expectedProfiles = timer.elapsed() / intervalMs;
+
+    for (int i = 0; i < numberOfSensors; i++) {
+        // The profiles parsed before the link was closed are still handled by the sensor thread
+        QTRY_COMPARE(profiles[i], sensors[i].parsedMsgs());
+        QCOMPARE(sensors[i]._droppedMessages.load(), 0);
+        QCOMPARE(sensors[i].parserErrors(), 0);
+
+        // Generous bounds, the sensor threads should not slow down each other
+        QVERIFY2(profiles[i] >= expectedProfiles / 4 && profiles[i] <= expectedProfiles * 5 / 4 + 1,
+            qPrintable(QString("Sensor %1 received %2 profiles, expected: %3")
+                           .arg(i)
+                           .arg(profiles[i])
+                           .arg(expectedProfiles)));
+
+        const auto fileLink = qobject_cast<FileLink*>(sensors[i].linkLog());
+        QVERIFY(fileLink);
+        QTRY_COMPARE(fileLink->logWriterStatistics().written.load(), static_cast<quint64>(profiles[i]));
+        QCOMPARE(fileLink->logWriterStatistics().dropped.load(), static_cast<quint64>(0));
+    }
+}
+
+void Test::sensorLogCompression()
+{
+    QTemporaryDir dir;
+    QVERIFY2(dir.isValid(), qPrintable("Temporary folder is not valid."));
+
+    const int numberOfPackets = 2000;
+    const QVector<QByteArray> packets = simulatedPing360Messages(numberOfPackets, 1200);
+
+    LogSensorStruct logSensorStruct;
+    logSensorStruct.init();
+    qint64 rawSize = 0;
+    for (const bool compress : {false, true}) {
+        const QString fileName = dir.filePath(compress ? "compressed.bin" : "raw.bin");
+
+        AsyncLogWriter writer;
+        QVERIFY2(writer.open(fileName, logSensorStruct, compress), qPrintable(writer.errorString()));
+        for (int i = 0; i < packets.size(); i++) {
+            // 20Hz
+            QVERIFY(writer.write(packets[i], i * 50000ull));
+        }
+        writer.close();
+        QCOMPARE(writer.statistics().written.load(), static_cast<quint64>(numberOfPackets));
+        QCOMPARE(writer.statistics().dropped.load(), static_cast<quint64>(0));
+        const qint64 fileSize = QFileInfo(fileName).size();
+        rawSize = compress ? rawSize : fileSize;
+        QVERIFY2(!compress || fileSize < rawSize,
+            qPrintable(QString("Log was not compressed: %1 bytes, raw: %2 bytes").arg(fileSize).arg(rawSize)));
+
+        QFile file(fileName);
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        QDataStream in(&file);
+        LogSensorStruct header;
+        in >> header;
+        QVERIFY2(header.isValid(), qPrintable("Log header is not valid."));
+        const qint64 firstPacketOffset = file.pos();
+        file.close();
+
+        // Index the log with and without the sidecar index
+        for (const bool useSidecar : {true, false}) {
+            if (!useSidecar) {
+                QVERIFY(QFile::remove(LogIndex::sidecarFileName(fileName)));
+            }
+
+            ProcessLog processLog;
+            processLog.setLogFile(fileName, firstPacketOffset, header.version, AbstractLink::_timeFormat);
+            QVERIFY(processLog.openLogFile());
+            QCOMPARE(processLog.isIndexComplete(), useSidecar);
+            while (!processLog.isIndexComplete()) {
+                processLog.indexPackets(100);
+            }
+            QCOMPARE(processLog.packageSize(), numberOfPackets - 1);
+
+            for (int i = 0; i < packets.size(); i++) {
+                QVERIFY2(processLog.readPacket(i) == packets[i], qPrintable(QString("Packet %1 is different").arg(i)));
+                QCOMPARE(processLog._index.at(i).angle, static_cast<quint16>(i % 400));
+            }
+        }
+
+        // Logs that can't be memory mapped are indexed and read from the file, the sidecar index was removed
+        ProcessLog unmappedLog;
+        unmappedLog.setLogFile(fileName, firstPacketOffset, header.version, AbstractLink::_timeFormat);
+        QVERIFY(unmappedLog.openLogFile());
+        unmappedLog._file.unmap(unmappedLog._map);
+        unmappedLog._map = nullptr;
+        while (!unmappedLog.isIndexComplete()) {
+            unmappedLog.indexPackets(100);
+        }
+        for (int i = 0; i < packets.size(); i++) {
+            QVERIFY2(unmappedLog.readPacket(i) == packets[i], qPrintable(QString("Packet %1 is different").arg(i)));
+            QCOMPARE(unmappedLog._index.at(i).angle, static_cast<quint16>(i % 400));
+        }
+    }
+}
+
 void Test::settingsManager()
 {
     auto settingsManager = SettingsManager::self();
@@ -137,6 +792,100 @@ void Test::settingsManager()
     settingsManager->distanceUnitsIndex(0);
 }
 
+void Test::slidingWindowExtremum()
+{
+    const int windowSize = 50;
+    SlidingWindowExtremum<float, std::less<float>> minimum(windowSize);
+    SlidingWindowExtremum<float, std::greater<float>> maximum(windowSize);
+    minimum.fill(1000);
+    maximum.fill(0);
+
+    // The filled values should leave the window like the appended ones
+    QVector<float> values(windowSize, 1000);
+    QVector<float> maxValues(windowSize, 0);
+    QRandomGenerator random(42);
+    for (int i = 0; i < 2000; i++) {
+        const float value = random.bounded(100);
+        const float nextMin = minimum.valueWith(value);
+        const float nextMax = maximum.valueWith(value);
+        minimum.append(value);
+        maximum.append(value);
+        values.append(value);
+        maxValues.append(value);
+
+        const float expectedMin = *std::min_element(values.cend() - windowSize, values.cend());
+        const float expectedMax = *std::max_element(maxValues.cend() - windowSize, maxValues.cend());
+        QVERIFY2(minimum.value() == expectedMin,
+            qPrintable(QString("Wrong min at %1: %2 != %3").arg(i).arg(minimum.value()).arg(expectedMin)));
+        QVERIFY2(maximum.value() == expectedMax,
+            qPrintable(QString("Wrong max at %1: %2 != %3").arg(i).arg(maximum.value()).arg(expectedMax)));
+        QCOMPARE(nextMin, expectedMin);
+        QCOMPARE(nextMax, expectedMax);
+    }
+}
+
+void Test::utilUpdate()
+{
+    // Same number of points of Util and Charts.qml
+    const int numberOfPoints = 2000;
+    // Samples are normalized with the same float operations of Util
+    const float sampleScale = 1 / 255.0f;
+    QtCharts::QLineSeries series;
+
+    // A single sample spike survives the decimation to the chart points
+    QByteArray profile(20 * numberOfPoints, 0);
+    profile[12345] = static_cast<char>(255);
+    Util::self()->update(&series, profile, 0, 100, 0, 100);
+    QVector<QPointF> points = series.pointsVector();
+    QCOMPARE(points.size(), 2 * numberOfPoints);
+    const auto maximum
+        = std::max_element(points.cbegin(), points.cend(), [](auto a, auto b) { return a.y() < b.y(); });
+    QCOMPARE(maximum->y(), static_cast<double>(sampleScale * 255));
+
+    // The chart is zero before and after the profile
+    profile = QByteArray(500, static_cast<char>(255));
+    Util::self()->update(&series, profile, 25, 75, 0, 100);
+    points = series.pointsVector();
+    QCOMPARE(points.size(), profile.size() + 4);
+    QCOMPARE(points[0], QPointF(0, 0));
+    QCOMPARE(points[1], QPointF(499, 0));
+    for (int i = 0; i < profile.size(); i++) {
+        QCOMPARE(points[i + 2], QPointF(500 + 2 * i, sampleScale * 255));
+    }
+    QCOMPARE(points[profile.size() + 2], QPointF(1500, 0));
+    QCOMPARE(points[profile.size() + 3], QPointF(numberOfPoints - 1, 0));
+
+    // Profiles without chart points only have the padding
+    Util::self()->update(&series, profile, 50, 50, 0, 100);
+    points = series.pointsVector();
+    QCOMPARE(points.size(), 4);
+    for (const auto& point : points) {
+        QCOMPARE(point.y(), 0.0);
+    }
+    QCOMPARE(points[1], QPointF(999, 0));
+    QCOMPARE(points[2], QPointF(1000, 0));
+
+    // Both buffers are reused while the range does not change
+    const auto& buffers = Util::self()->_seriesBuffers[&series].buffers;
+    Util::self()->update(&series, profile, 25, 75, 0, 100);
+    Util::self()->update(&series, profile, 25, 75, 0, 100);
+    const QPointF* data[2] = {buffers[0].points.constData(), buffers[1].points.constData()};
+    for (int i = 0; i < 4; i++) {
+        profile.fill(static_cast<char>(i));
+        Util::self()->update(&series, profile, 25, 75, 0, 100);
+        QCOMPARE(buffers[0].points.constData(), data[0]);
+        QCOMPARE(buffers[1].points.constData(), data[1]);
+        QCOMPARE(series.pointsVector()[2].y(), static_cast<double>(sampleScale * i));
+    }
+
+    // The layout is only calculated again when the range changes
+    Util::self()->update(&series, profile, 10, 75, 0, 100);
+    const int next = Util::self()->_seriesBuffers[&series].next;
+    QCOMPARE(buffers[1 - next].startPoint, 200);
+    QCOMPARE(buffers[next].startPoint, 500);
+    QCOMPARE(series.pointsVector()[1], QPointF(199, 0));
+}
+
 void Test::waterfallGradient()
 {
     QVector<QColor> colorList = {Qt::black, Qt::white};
@@ -169,4 +918,216 @@ void Test::waterfallGradient()
     QVERIFY2(qFuzzyCompare(value1, 1), qPrintable(QString("Value does not match: %1").arg(value1)));
 }
 
+void Test::waterfallColorTable()
+{
+    PolarPlot plot;
+    const auto gradient = plot.waterfallGradient();
+
+    // The lookup table should match the gradient in all quantized positions
+    for (int i = 0; i < Waterfall::_colorTableSize; i++) {
+        const float value = i / static_cast<float>(Waterfall::_colorTableSize - 1);
+        const QColor expected = gradient->getColor(value);
+        const QColor color = plot.valueToRGB(value);
+        QVERIFY2(color == expected,
+            qPrintable(QString("Color does not match for %1: %2 != %3").arg(value).arg(color.name(), expected.name())));
+    }
+
+    // Bulk conversion should provide the same result of the single value version
+    const QVector<float> values = {-1.0f, 0.0f, 0.25f, 0.5f, 0.75f, 1.0f, 2.0f, std::nanf("")};
+    QVector<uint32_t> pixels(values.size());
+    plot.valuesToRGBA(values.constData(), pixels.data(), values.size());
+    for (int i = 0; i < values.size(); i++) {
+        QVERIFY2(pixels[i] == plot.valueToRGBA(values[i]),
+            qPrintable(QString("Bulk color does not match for %1").arg(values[i])));
+    }
+
+    // Values outside of the valid range should be clamped
+    QVERIFY2(plot.valueToRGBA(-1.0f) == plot.valueToRGBA(0.0f), qPrintable("Negative value is not clamped."));
+    QVERIFY2(plot.valueToRGBA(2.0f) == plot.valueToRGBA(1.0f), qPrintable("Value bigger than 1 is not clamped."));
+
+    // 8 bits samples should have the same colors of the normalized values
+    QImage image(Waterfall::_colorTableSize, 1, QImage::Format_ARGB32_Premultiplied);
+    QVector<uint8_t> samples(Waterfall::_colorTableSize);
+    for (int i = 0; i < samples.size(); i++) {
+        samples[i] = i;
+    }
+    plot.drawRow(image, 0, samples.constData(), samples.size());
+    const auto row = reinterpret_cast<const uint32_t*>(image.constScanLine(0));
+    for (int i = 0; i < samples.size(); i++) {
+        QVERIFY2(
+            row[i] == plot.valueToRGBA(i / 255.0f), qPrintable(QString("Sample color does not match for %1").arg(i)));
+    }
+}
+
+void Test::waterfallPlotColumns()
+{
+    WaterfallPlot plot;
+    const int width = WaterfallPlot::_displayWidth;
+
+    // Long profiles fill the ring buffer, the shorter profiles of the next lap are drawn over them with the same scale
+    for (int i = 0; i < width + width / 2; i++) {
+        Profile::Data data;
+        data.length = i < width ? 100 : 20 + i % 30;
+        data.samples = QByteArray(200, static_cast<char>(0xff));
+        plot.draw(Profile(std::move(data)));
+        // Avoid dropped draws when the queue is full
+        if (i % 100 == 0) {
+            plot._renderer.waitForIdle();
+        }
+    }
+    plot._renderer.waitForIdle();
+
+    const QImage image = plot._renderer.image();
+    const WaterfallPlot::DepthScale scale = plot.depthScale();
+    for (int column = 0; column < image.width(); column++) {
+        const auto& profile = plot._columnProfiles[column];
+        QCOMPARE(profile.length, column < width / 2 ? 20.0f + (width + column) % 30 : 100.0f);
+
+        int virtualFloor = 0;
+        int virtualHeight = 0;
+        QVERIFY(plot.columnRows(
+            scale, profile.initialDepth, profile.length, profile.samples.size(), virtualFloor, virtualHeight));
+        QVERIFY2(image.pixel(column, virtualFloor) != 0, qPrintable(QString("Column %1 is empty").arg(column)));
+        int staleRow = -1;
+        for (int row = 0; row < image.height() && staleRow < 0; row++) {
+            const bool profileRow = row >= virtualFloor && row < virtualFloor + virtualHeight;
+            staleRow = !profileRow && image.pixel(column, row) != 0 ? row : -1;
+        }
+        QVERIFY2(staleRow < 0,
+            qPrintable(QString("Stale pixel of the previous lap in column %1, row %2").arg(column).arg(staleRow)));
+    }
+}
+
+void Test::waterfallRenderer()
+{
+    WaterfallRenderer renderer;
+    QImage image(8, 8, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::black);
+    renderer.setImage(image);
+    QTRY_COMPARE(renderer.image().size(), image.size());
+
+    // Each pixel is drawn in a different frame, the swapped buffers should keep the pixels of the previous frames
+    const QRgb white = qRgb(255, 255, 255);
+    for (int i = 0; i < image.width(); i++) {
+        renderer.render([i, white](QImage& backImage, QRegion& dirtyRegion) {
+            backImage.setPixel(i, i, white);
+            dirtyRegion += QRect(i, i, 1, 1);
+        });
+        QTRY_COMPARE(renderer.image().pixel(i, i), white);
+    }
+
+    const QImage frame = renderer.image();
+    for (int i = 0; i < image.width(); i++) {
+        QVERIFY2(frame.pixel(i, i) == white, qPrintable(QString("Pixel of a previous frame was lost: %1").arg(i)));
+        QVERIFY2(frame.pixel(image.width() - 1 - i, i) == qRgb(0, 0, 0),
+            qPrintable(QString("Pixel out of the dirty region changed: %1").arg(i)));
+    }
+
+    // The dirty region is accumulated until the frame is read
+    renderer.readFrame([&](const QImage&, const QRegion& dirtyRegion) {
+        QCOMPARE(dirtyRegion.boundingRect(), image.rect());
+    });
+    renderer.readFrame([](const QImage&, const QRegion& dirtyRegion) { QVERIFY(dirtyRegion.isEmpty()); });
+
+    // Jobs that can be dropped are lost when the queue is full, the other jobs wait for the worker
+    std::atomic<int> executed {0};
+    renderer.jobMutex()->lock();
+    int queued = 0;
+    while (renderer.tryRender([&executed](QImage&, QRegion&) { executed++; })) {
+        queued++;
+    }
+    QVERIFY(queued >= WaterfallRenderer::queueCapacity);
+    QCOMPARE(renderer.dropped(), static_cast<quint64>(1));
+    renderer.jobMutex()->unlock();
+    QVERIFY(renderer.render([&executed](QImage&, QRegion&) { executed++; }));
+    renderer.waitForIdle();
+    QCOMPARE(executed.load(), queued + 1);
+
+    // Jobs queued after stop are ignored
+    renderer.stop();
+    QVERIFY(!renderer.render([](QImage&, QRegion&) {}));
+}
+
+void Test::waterfallSceneGraph()
+{
+    // Backend of the headless machines, it should be set before the first window is created
+    QQuickWindow::setSceneGraphBackend(QSGRendererInterface::Software);
+    QQuickWindow window;
+    window.setColor(Qt::black);
+    window.resize(1200, 575);
+
+    // One item pixel for each column of the waterfall and for each pixel of the polar image
+    WaterfallPlot waterfallPlot(window.contentItem());
+    waterfallPlot.setSize(QSizeF(WaterfallPlot::_displayWidth, 175));
+    waterfallPlot.setSmooth(false);
+    PolarPlot polarPlot(window.contentItem());
+    polarPlot.setPosition(QPointF(0, 175));
+    polarPlot.setSize(QSizeF(1200, 400));
+    window.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&window));
+
+    const auto createProfile = [](int numberOfSamples, uint8_t value, float angle = 0) {
+        Profile::Data data;
+        data.angle = angle;
+        data.length = 100;
+        data.samples = QByteArray(numberOfSamples, static_cast<char>(value));
+        return Profile(std::move(data));
+    };
+    const auto drawWaterfall = [&](int numberOfProfiles, uint8_t value) {
+        for (int i = 0; i < numberOfProfiles; i++) {
+            waterfallPlot.draw(createProfile(200, value));
+            // Avoid dropped draws when the queue is full
+            if (i % 100 == 0) {
+                waterfallPlot._renderer.waitForIdle();
+            }
+        }
+        waterfallPlot._renderer.waitForIdle();
+    };
+    const auto grabWindow = [&] {
+        polarPlot.drawPendingProfiles();
+        polarPlot._renderer.waitForIdle();
+        waterfallPlot.update();
+        polarPlot.update();
+        return window.grabWindow();
+    };
+    // The images are drawn over a black window, the premultiplied colors are not changed
+    const auto isColor = [&waterfallPlot](const QImage& image, int x, int y, int value) {
+        const QRgb pixel = image.pixel(x, y);
+        const QRgb expected = value < 0 ? qRgb(0, 0, 0) : waterfallPlot.valueToRGBA(value / 255.0f);
+        return std::abs(qRed(pixel) - qRed(expected)) <= 2 && std::abs(qGreen(pixel) - qGreen(expected)) <= 2
+            && std::abs(qBlue(pixel) - qBlue(expected)) <= 2;
+    };
+
+    // A full lap of the ring buffer, the next column is the first one again
+    drawWaterfall(WaterfallPlot::_displayWidth, 60);
+    polarPlot.draw(createProfile(1200, 90, 100), 10, 360);
+    polarPlot.draw(createProfile(1200, 230, 300), 10, 360);
+    QImage image = grabWindow();
+    QCOMPARE(waterfallPlot._frameDrawIndex.load(), 0);
+    QVERIFY(isColor(image, 10, 80, 60));
+    QVERIFY(isColor(image, 490, 80, 60));
+    QVERIFY(isColor(image, 600, 175 + 100, 90));
+    QVERIFY(isColor(image, 600, 175 + 300, 230));
+    QVERIFY(isColor(image, 600, 175 + 200, -1));
+
+    // The oldest columns are on the left, the wrapped ones on the right
+    drawWaterfall(100, 200);
+    image = grabWindow();
+    QCOMPARE(waterfallPlot._frameDrawIndex.load(), 100);
+    QVERIFY(isColor(image, 200, 80, 60));
+    QVERIFY(isColor(image, 397, 80, 60));
+    QVERIFY(isColor(image, 402, 80, 200));
+    QVERIFY(isColor(image, 499, 80, 200));
+
+    // Partial updates of a single waterfall column and of a single polar angle
+    drawWaterfall(1, 120);
+    polarPlot.draw(createProfile(1200, 170, 100), 10, 360);
+    image = grabWindow();
+    QVERIFY(isColor(image, 200, 80, 60));
+    QVERIFY(isColor(image, 450, 80, 200));
+    QVERIFY(isColor(image, 499, 80, 120));
+    QVERIFY(isColor(image, 600, 175 + 100, 170));
+    QVERIFY(isColor(image, 600, 175 + 300, 230));
+}
+
 QTEST_MAIN(Test)
\ No newline at end of file
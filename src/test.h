@@ -13,33 +13,148 @@ private slots:
      */
     void initTestCase();
 
+    /**
+     * @brief Test batch rendering of logs to images, image names and failures
+     *
+     */
+    void batchRenderer();
+
+    /**
+     * @brief Test profile decimation with random sizes
+     *
+     */
+    void decimation();
+
     /**
      * @brief Test file manager
      *
      */
     void fileManager();
 
+    /**
+     * @brief Test log catalog information and cache
+     *
+     */
+    void logCatalog();
+
     /**
      * @brief Test logger singleton
      *
      */
     void logger();
 
+    /**
+     * @brief Test log sidecar index
+     *
+     */
+    void logIndex();
+
+    /**
+     * @brief Test log keyframes with random angles
+     *
+     */
+    void logKeyframes();
+
+    /**
+     * @brief Test max segment tree with random values
+     *
+     */
+    void maxSegmentTree();
+
+    /**
+     * @brief Test ping checksum with random lengths
+     *
+     */
+    void pingChecksum();
+
+    /**
+     * @brief Test ping parser with a Ping360 stream
+     *
+     */
+    void pingParser();
+
+    /**
+     * @brief Test polar plot profile bursts, order of a batch and retry when the render queue is full
+     *
+     */
+    void polarPlotDraw();
+
+    /**
+     * @brief Test shared profile
+     *
+     */
+    void profile();
+
+    /**
+     * @brief Test replay scheduler deadlines, speed and interruption
+     *
+     */
+    void replayScheduler();
+
     /**
      * @brief Test ring vector
      *
      */
     void ringVector();
 
+    /**
+     * @brief Test two sensors with simulation links, each one with its own link thread
+     *
+     */
+    void sensorLinkThreads();
+
+    /**
+     * @brief Test asynchronous sensor log writer and reader with and without compression
+     *
+     */
+    void sensorLogCompression();
+
     /**
      * @brief Test settings manager
      *
      */
     void settingsManager();
 
+    /**
+     * @brief Test sliding window min and max with random values
+     *
+     */
+    void slidingWindowExtremum();
+
+    /**
+     * @brief Test chart series update with decimation, layout and buffer reuse
+     *
+     */
+    void utilUpdate();
+
     /**
      * @brief Test waterfall gradient
      *
      */
     void waterfallGradient();
+
+    /**
+     * @brief Test waterfall color lookup table
+     *
+     */
+    void waterfallColorTable();
+
+    /**
+     * @brief Test waterfall plot ring buffer columns, reused columns should not keep the previous profile
+     *
+     */
+    void waterfallPlotColumns();
+
+    /**
+     * @brief Test waterfall render worker, frame swap and full queue
+     *
+     */
+    void waterfallRenderer();
+
+    /**
+     * @brief Test waterfall and polar plot scene graph nodes in a window with the software backend
+     *  It covers the ring buffer wrap and partial updates of the displayed image
+     *
+     */
+    void waterfallSceneGraph();
 };
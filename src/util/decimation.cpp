@@ -0,0 +1,157 @@
+#include <algorithm>
+#include <vector>
+
+#include "decimation.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__)
+#define PING_DECIMATION_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+// Tables are reused between calls, each thread has its own
+thread_local std::vector<uint8_t> maxTable;
+thread_local std::vector<uint8_t> minTable;
+
+template <bool isMax> uint8_t extreme(uint8_t first, uint8_t second)
+{
+    return isMax ? std::max(first, second) : std::min(first, second);
+}
+
+/**
+ * @brief Calculate the extreme of pairs of values, output[i] = extreme(input[i], input[i + step])
+ *  The output is written in increasing order, it can be the input buffer
+ *
+ * @tparam isMax
+ * @param input
+ * @param output
+ * @param count
+ * @param step
+ */
+template <bool isMax> void extremeOfPairs(const uint8_t* input, uint8_t* output, int count, int step)
+{
+    int i = 0;
+#ifdef PING_DECIMATION_SSE2
+    for (; i + 16 <= count; i += 16) {
+        const __m128i first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i));
+        const __m128i second = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i + step));
+        const __m128i result = isMax ? _mm_max_epu8(first, second) : _mm_min_epu8(first, second);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i), result);
+    }
+#endif
+    for (; i < count; i++) {
+        output[i] = extreme<isMax>(input[i], input[i + step]);
+    }
+}
+
+/**
+ * @brief Build a table where table[i] is the extreme of samples [i, i + span)
+ *  span is the biggest power of two not bigger than minimumRange, any range with at least span samples is the
+ *  extreme of two overlapping table entries
+ *
+ * @tparam isMax
+ * @param samples
+ * @param length
+ * @param minimumRange
+ * @param table
+ * @param span
+ * @return const uint8_t* table values, the samples are used directly when span is 1
+ */
+template <bool isMax>
+const uint8_t* extremeTable(const uint8_t* samples, int length, int minimumRange, std::vector<uint8_t>& table, int& span)
+{
+    span = 1;
+    const uint8_t* values = samples;
+    if (minimumRange < 2) {
+        return values;
+    }
+
+    table.resize(length);
+    for (; span * 2 <= minimumRange; span *= 2) {
+        extremeOfPairs<isMax>(values, table.data(), length - 2 * span + 1, span);
+        values = table.data();
+    }
+    return values;
+}
+
+/**
+ * @brief Ranges of samples of each output value, [i * length / outputLength, (i + 1) * length / outputLength)
+ *  The limits are calculated incrementally, avoiding a division for each value
+ *
+ */
+class Ranges {
+public:
+    Ranges(int length, int outputLength)
+        : _end(0)
+        , _outputLength(outputLength)
+        , _remainder(0)
+        , _remainderStep(length % outputLength)
+        , _step(length / outputLength)
+    {
+    }
+
+    /**
+     * @brief Move to the next range and return its end, the start is the end of the previous range
+     *
+     * @return int
+     */
+    int next()
+    {
+        _end += _step;
+        _remainder += _remainderStep;
+        if (_remainder >= _outputLength) {
+            _remainder -= _outputLength;
+            _end++;
+        }
+        return _end;
+    }
+
+private:
+    int _end;
+    const int _outputLength;
+    int _remainder;
+    const int _remainderStep;
+    const int _step;
+};
+
+template <bool isMax>
+void decimate(const uint8_t* samples, int length, uint8_t* output, int outputLength, std::vector<uint8_t>& table)
+{
+    if (length <= 0 || outputLength <= 0) {
+        return;
+    }
+
+    Ranges ranges(length, outputLength);
+    int start = 0;
+
+    // Upsampling, the first sample of the range is used
+    if (length < outputLength) {
+        for (int i = 0; i < outputLength; i++) {
+            output[i] = samples[start];
+            start = ranges.next();
+        }
+        return;
+    }
+
+    int span = 1;
+    const uint8_t* values = extremeTable<isMax>(samples, length, length / outputLength, table, span);
+    for (int i = 0; i < outputLength; i++) {
+        const int end = ranges.next();
+        output[i] = extreme<isMax>(values[start], values[end - span]);
+        start = end;
+    }
+}
+
+}
+
+void Decimation::resampleMax(const uint8_t* samples, int length, uint8_t* output, int outputLength)
+{
+    decimate<true>(samples, length, output, outputLength, maxTable);
+}
+
+void Decimation::minMax(const uint8_t* samples, int length, uint8_t* minimum, uint8_t* maximum, int buckets)
+{
+    decimate<false>(samples, length, minimum, buckets, minTable);
+    decimate<true>(samples, length, maximum, buckets, maxTable);
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * @brief Decimation of 8 bits sample profiles
+ *  Ranges of samples are reduced to their extremes, narrow echoes are kept where nearest neighbour resampling would
+ *  skip them. The extremes of all ranges are found with a few vectorized passes over the samples (SSE2 when
+ *  available), each pass doubles the covered range, the cost does not depend of the decimation ratio.
+ */
+namespace Decimation {
+
+/**
+ * @brief Resample a profile to a number of pixels
+ *  When there are more samples than pixels each pixel gets the maximum of its range of samples,
+ *  otherwise the nearest sample is used.
+ *  The samples of pixel i are [i * length / outputLength, (i + 1) * length / outputLength).
+ *
+ * @param samples
+ * @param length
+ * @param output buffer with outputLength bytes
+ * @param outputLength
+ */
+void resampleMax(const uint8_t* samples, int length, uint8_t* output, int outputLength);
+
+/**
+ * @brief Calculate the minimum and the maximum of each bucket of samples
+ *  Buckets have the same ranges of resampleMax pixels, the nearest sample is used when there are more buckets than
+ *  samples.
+ *
+ * @param samples
+ * @param length
+ * @param minimum buffer with buckets bytes
+ * @param maximum buffer with buckets bytes
+ * @param buckets
+ */
+void minMax(const uint8_t* samples, int length, uint8_t* minimum, uint8_t* maximum, int buckets);
+
+}
@@ -2,11 +2,19 @@
 #include <QSerialPortInfo>
 #include <QtCharts/QXYSeries>
 
+#include <algorithm>
+
+#include "decimation.h"
 #include "logger.h"
 #include "util.h"
 
 PING_LOGGING_CATEGORY(util, "ping.util");
 
+namespace {
+// This value should be updated in Charts.qml to make it compatible
+const int numberOfPoints = 2000;
+}
+
 Util::Util() { QQmlEngine::setObjectOwnership(this, QQmlEngine::CppOwnership); }
 
 QStringList Util::serialPortList()
@@ -21,14 +29,11 @@ QStringList Util::serialPortList()
     return portNameList;
 }
 
-void Util::update(QtCharts::QAbstractSeries* series, const QVector<double>& points, const float initPos,
+void Util::update(QtCharts::QAbstractSeries* series, const QByteArray& profile, const float initPos,
     const float finalPos, const float minPoint, const float maxPoint, const float multiplier)
 {
-    // This value should be updated in Charts.qml to make it compatible
-    static const int numberOfPoints = 2000;
-
     // Check inputs
-    if (!series || points.isEmpty()) {
+    if (!series || profile.isEmpty()) {
         qCDebug(util) << "Serie or vector not valid.";
         return;
     }
@@ -40,36 +45,74 @@ void Util::update(QtCharts::QAbstractSeries* series, const QVector<double>& poin
 
     // Points per Meter
     const float distPoints = numberOfPoints / (maxPoint - minPoint);
+    const int startPoint = int(distPoints * (initPos - minPoint));
+    const int dataPoints = std::max(0, int((finalPos - initPos) * distPoints));
 
-    QXYSeries* xySeries = static_cast<QXYSeries*>(series);
+    // Each chart point has the min and max of its samples when the profile is decimated
+    const bool decimate = profile.size() > dataPoints;
+    const int buckets = std::min(dataPoints, profile.size());
+    const int pointsPerBucket = decimate ? 2 : 1;
 
-    // Use replace instead of clear + append, it's optimized for performance
-    QVector<QPointF> realPoints;
-    realPoints.reserve(numberOfPoints);
-
-    // Start
-    const int lastStartPoint = int(distPoints * (initPos - minPoint));
-#pragma omp for
-    for (int i = 0; i < lastStartPoint; i++) {
-        realPoints << QPointF(i, 0);
+    // The series shares the last buffer, the other one can be written without a copy
+    if (!_seriesBuffers.contains(series)) {
+        connect(series, &QObject::destroyed, this, [this, series] { _seriesBuffers.remove(series); });
+    }
+    auto& seriesBuffers = _seriesBuffers[series];
+    auto& seriesPoints = seriesBuffers.buffers[seriesBuffers.next];
+    seriesBuffers.next = 1 - seriesBuffers.next;
+    if (seriesPoints.startPoint != startPoint || seriesPoints.dataPoints != dataPoints
+        || seriesPoints.buckets != buckets || seriesPoints.pointsPerBucket != pointsPerBucket) {
+        updateLayout(seriesPoints, startPoint, dataPoints, buckets, pointsPerBucket);
+    }
+
+    // Samples are normalized to [0-1]
+    const float sampleScale = multiplier / 255.0f;
+    const auto samples = reinterpret_cast<const uint8_t*>(profile.constData());
+    QPointF* points = seriesPoints.points.data() + seriesPoints.dataOffset;
+    if (decimate) {
+        _minimumSamples.resize(buckets);
+        _maximumSamples.resize(buckets);
+        Decimation::minMax(samples, profile.size(), _minimumSamples.data(), _maximumSamples.data(), buckets);
+        for (int i = 0; i < buckets; i++) {
+            points[2 * i].setY(sampleScale * _minimumSamples[i]);
+            points[2 * i + 1].setY(sampleScale * _maximumSamples[i]);
+        }
+    } else {
+        for (int i = 0; i < buckets; i++) {
+            points[i].setY(sampleScale * samples[i]);
+        }
     }
 
-    // Data
-    const int lastDataPoint = int((finalPos - initPos) * distPoints);
-    const float dataIndexScale = points.length() / ((finalPos - initPos) * distPoints);
-#pragma omp for
-    for (int i = 0; i < lastDataPoint; i++) {
-        realPoints << QPointF(i + lastStartPoint, multiplier * points[static_cast<int>(i * dataIndexScale)]);
+    // Use replace instead of clear + append, it's optimized for performance
+    static_cast<QXYSeries*>(series)->replace(seriesPoints.points);
+}
+
+void Util::updateLayout(SeriesPoints& seriesPoints, int startPoint, int dataPoints, int buckets, int pointsPerBucket)
+{
+    seriesPoints.startPoint = startPoint;
+    seriesPoints.dataPoints = dataPoints;
+    seriesPoints.buckets = buckets;
+    seriesPoints.pointsPerBucket = pointsPerBucket;
+
+    // The chart is empty before and after the profile, the lines only need the limits
+    auto& points = seriesPoints.points;
+    points.clear();
+    if (startPoint > 0) {
+        points << QPointF(0, 0) << QPointF(startPoint - 1, 0);
     }
 
-// Final
-#pragma omp for
-    for (int i = realPoints.length(); i < numberOfPoints; i++) {
-        realPoints << QPointF(i, 0);
+    seriesPoints.dataOffset = points.size();
+    const float bucketWidth = buckets ? static_cast<float>(dataPoints) / buckets : 0;
+    for (int i = 0; i < buckets; i++) {
+        for (int j = 0; j < pointsPerBucket; j++) {
+            points << QPointF(startPoint + i * bucketWidth, 0);
+        }
     }
 
-    // Do replace
-    xySeries->replace(realPoints);
+    const int endPoint = std::max(0, startPoint + dataPoints);
+    if (endPoint < numberOfPoints) {
+        points << QPointF(endPoint, 0) << QPointF(numberOfPoints - 1, 0);
+    }
 }
 
 void Util::restartApplication()
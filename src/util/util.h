@@ -19,17 +19,19 @@ class Util : public QObject {
 
 public:
     /**
-     * @brief Create a QAbstractSeries from a list of points
+     * @brief Create a QAbstractSeries from a profile
+     *  Profiles with more samples than chart points are decimated to the min and max of each point, narrow echoes are
+     *  kept. The point buffers are reused, the x coordinates are only calculated when the range changes.
      *
      * @param series
-     * @param points
+     * @param profile one byte per sample, where 255 is the maximum power
      * @param initPos
      * @param finalPos
      * @param minPoint
      * @param maxPoint
      * @param multiplier
      */
-    Q_INVOKABLE void update(QtCharts::QAbstractSeries* series, const QVector<double>& points, const float initPos,
+    Q_INVOKABLE void update(QtCharts::QAbstractSeries* series, const QByteArray& profile, const float initPos,
         const float finalPos, const float minPoint, const float maxPoint, const float multiplier = 1);
 
     /**
@@ -79,4 +81,45 @@ private:
      *
      */
     Util();
+
+    /**
+     * @brief Points of a chart series with the layout used to calculate the x coordinates
+     *
+     */
+    struct SeriesPoints {
+        QVector<QPointF> points;
+        int startPoint = 0;
+        int dataPoints = -1;
+        int buckets = -1;
+        int pointsPerBucket = 0;
+        // Index of the first profile point
+        int dataOffset = 0;
+    };
+
+    /**
+     * @brief Point buffers of a chart series
+     *  The series shares the last buffer, the other one is written in the next update without allocations
+     *
+     */
+    struct SeriesBuffers {
+        SeriesPoints buffers[2];
+        int next = 0;
+    };
+
+    /**
+     * @brief Calculate the x coordinates of the points, the points out of the profile are zero
+     *
+     * @param seriesPoints
+     * @param startPoint first chart point of the profile
+     * @param dataPoints number of chart points of the profile
+     * @param buckets number of profile ranges
+     * @param pointsPerBucket 2 when the min and max are used, 1 otherwise
+     */
+    static void updateLayout(
+        SeriesPoints& seriesPoints, int startPoint, int dataPoints, int buckets, int pointsPerBucket);
+
+    // Profile min and max of each chart point, reused between updates
+    QVector<uint8_t> _maximumSamples;
+    QVector<uint8_t> _minimumSamples;
+    QHash<QtCharts::QAbstractSeries*, SeriesBuffers> _seriesBuffers;
 };
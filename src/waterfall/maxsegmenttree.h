@@ -0,0 +1,77 @@
+#pragma once
+
+#include <algorithm>
+
+#include <QVector>
+
+/**
+ * @brief Table of values that keeps track of its maximum
+ *  Values are the leaves of a binary tree where each node holds the maximum of its children.
+ *  Changing a value is O(log n) and the maximum is O(1).
+ *
+ * @tparam T
+ */
+template <typename T> class MaxSegmentTree {
+public:
+    /**
+     * @brief Construct a new Max Segment Tree object
+     *
+     * @param size number of values
+     * @param value initial value
+     */
+    explicit MaxSegmentTree(int size, const T& value = T())
+        : _size(size)
+    {
+        fill(value);
+    }
+
+    /**
+     * @brief Set all values
+     *
+     * @param value
+     */
+    void fill(const T& value) { _nodes.fill(value, 2 * _size); }
+
+    /**
+     * @brief Change a value and update the nodes up to the root
+     *
+     * @param index
+     * @param value
+     */
+    void set(int index, const T& value)
+    {
+        Q_ASSERT(index >= 0 && index < _size);
+        int node = index + _size;
+        _nodes[node] = value;
+        for (node /= 2; node >= 1; node /= 2) {
+            _nodes[node] = std::max(_nodes[2 * node], _nodes[2 * node + 1]);
+        }
+    }
+
+    /**
+     * @brief Return a value
+     *
+     * @param index
+     * @return const T&
+     */
+    const T& at(int index) const { return _nodes[index + _size]; }
+
+    /**
+     * @brief Return the maximum of all values
+     *
+     * @return const T&
+     */
+    const T& max() const { return _size > 1 ? _nodes[1] : _nodes[_size]; }
+
+    /**
+     * @brief Return the number of values
+     *
+     * @return int
+     */
+    int size() const { return _size; }
+
+private:
+    // The leaves are stored after the internal nodes, node 1 is the root and node 0 is not used
+    QVector<T> _nodes;
+    int _size;
+};
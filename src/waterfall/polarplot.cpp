@@ -1,33 +1,36 @@
 #include "polarplot.h"
+#include "decimation.h"
 #include "filemanager.h"
 
+#include <cmath>
+#include <cstring>
 #include <limits>
 
-#include <QPainter>
 #include <QVector>
 #include <QtConcurrent>
 #include <QtMath>
 
 PING_LOGGING_CATEGORY(polarplot, "ping.polarplot")
 
-// Number of samples to display
-uint16_t PolarPlot::_angularResolution = 400;
+namespace {
+// The angles of the profiles are in gradians, a full turn has 400
+const int maxGradian = 400;
+}
 
 PolarPlot::PolarPlot(QQuickItem* parent)
     : Waterfall(parent)
-    , _distances(_angularResolution, 0)
-    , _image(400, 1200, QImage::Format_RGBA8888)
+    , _angularResolution(400)
+    , _distances(maxGradian, 0)
     , _maxDistance(0)
-    , _painter(nullptr)
+    , _rangeResolution(1200)
     , _sectorSizeDegrees(0)
 {
+    resetImage();
     setAcceptedMouseButtons(Qt::AllButtons);
     setAcceptHoverEvents(true);
-    _image.fill(QColor(Qt::transparent));
 
-    connect(&_updateTimer, &QTimer::timeout, this, [&] { update(); });
-    _updateTimer.setSingleShot(true);
-    _updateTimer.start(50);
+    _pendingTimer.setSingleShot(true);
+    connect(&_pendingTimer, &QTimer::timeout, this, &PolarPlot::drawPendingProfiles);
 
     connect(this, &Waterfall::mousePosChanged, this, &PolarPlot::updateMouseColumnData);
     connect(this, &Waterfall::themeChanged, this, &PolarPlot::clear);
@@ -36,35 +39,105 @@ PolarPlot::PolarPlot(QQuickItem* parent)
 void PolarPlot::clear()
 {
     qCDebug(polarplot) << "Cleaning waterfall and restarting internal variables";
-    _image.fill(Qt::transparent);
-    _distances.fill(0, _angularResolution);
+    _pendingProfiles.clear();
+    _pendingTimer.stop();
+    _renderer.render([](QImage& image, QRegion& dirtyRegion) {
+        image.fill(Qt::transparent);
+        dirtyRegion += image.rect();
+    });
+    _distances.fill(0);
     _maxDistance = 0;
 }
 
-void PolarPlot::paint(QPainter* painter)
+QVector<WaterfallNode::PaintRegion> PolarPlot::paintRegions(const QSize& imageSize) const
+{
+    return {{boundingRect(), QRectF(QPointF(0, 0), imageSize)}};
+}
+
+QImage PolarPlot::frameToImage(const QImage& frame) const
+{
+    // Same transformation of the polar plot fragment shader, rows are angles and columns are distances
+    const QImage source = frame.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    const int diameter = 2 * source.width();
+    const float radius = source.width();
+    QImage image(diameter, diameter, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::transparent);
+
+    for (int y = 0; y < diameter; y++) {
+        auto line = reinterpret_cast<QRgb*>(image.scanLine(y));
+        const float relativeY = (y + 0.5f - radius) / radius;
+        for (int x = 0; x < diameter; x++) {
+            const float relativeX = (x + 0.5f - radius) / radius;
+            const float distance = std::hypot(relativeX, relativeY);
+            if (distance > 1) {
+                continue;
+            }
+
+            // Zero is the top of the disk and the angle grows clockwise
+            float angle = std::atan2(relativeY, relativeX) / static_cast<float>(2 * M_PI) + 0.25f;
+            angle -= std::floor(angle);
+            const int row = std::min(static_cast<int>(angle * source.height()), source.height() - 1);
+            const int column = std::min(static_cast<int>(distance * source.width()), source.width() - 1);
+            line[x] = reinterpret_cast<const QRgb*>(source.constScanLine(row))[column];
+        }
+    }
+    return image;
+}
+
+void PolarPlot::resetImage()
+{
+    // Each row is an angle and each column a sample distance, one profile is a contiguous scan line
+    QImage image(_rangeResolution, _angularResolution, QImage::Format_ARGB32_Premultiplied);
+    image.fill(QColor(Qt::transparent));
+    _renderer.setImage(image);
+}
+
+void PolarPlot::setAngularResolution(int angularResolution)
 {
-    static QPixmap pix;
-    if (painter != _painter) {
-        _painter = painter;
+    if (angularResolution == _angularResolution) {
+        return;
+    }
+    if (angularResolution < 1) {
+        qCWarning(polarplot) << "Invalid angular resolution:" << angularResolution;
+        return;
+    }
+
+    _angularResolution = angularResolution;
+    resetImage();
+    emit angularResolutionChanged();
+    emit imageChanged();
+}
+
+void PolarPlot::setRangeResolution(int rangeResolution)
+{
+    if (rangeResolution == _rangeResolution) {
+        return;
+    }
+    if (rangeResolution < 1) {
+        qCWarning(polarplot) << "Invalid range resolution:" << rangeResolution;
+        return;
     }
 
-    // http://blog.qt.io/blog/2006/05/13/fast-transformed-pixmapimage-drawing/
-    pix = QPixmap::fromImage(_image, Qt::NoFormatConversion);
-    _painter->drawPixmap(QRect(0, 0, width(), height()), pix, QRect(0, 0, _image.width(), _image.height()));
+    _rangeResolution = rangeResolution;
+    resetImage();
+    emit rangeResolutionChanged();
+    emit imageChanged();
 }
 
 void PolarPlot::setImage(const QImage& image)
 {
-    _image = image;
+    _renderer.setImage(image);
     emit imageChanged();
     setImplicitWidth(image.width());
     setImplicitHeight(image.height());
 }
 
-void PolarPlot::draw(
-    const QVector<double>& points, float angle, float initPoint, float length, float angleGrad, float sectorSize)
+void PolarPlot::draw(const Profile& profile, float angleGrad, float sectorSize)
 {
-    static const int maxGradian = 400;
+    if (profile.samples().isEmpty()) {
+        return;
+    }
+
     const float sectorSizeGradian = sectorSize * 200.0f / 180.0f;
 
     if (_sectorSizeDegrees != sectorSize) {
@@ -73,45 +146,85 @@ void PolarPlot::draw(
     }
 
     // TODO: Need a better way to deal with dynamic steps, maybe doing `draw(data, angle++)` with `angleGrad` loop
+    float angle = profile.angle();
     while (angle < 0) {
         angle += maxGradian;
     }
-    _distances[static_cast<int>(angle) % _angularResolution] = initPoint + length;
 
-    float maxDistance = 0;
-    for (const auto distance : _distances) {
-        if (distance > maxDistance) {
-            maxDistance = distance;
-        }
+    // The profile is shared with the render worker, the samples are not copied
+    _pendingProfiles.append({profile, angle, angleGrad, sectorSizeGradian});
+    if (!_pendingTimer.isActive()) {
+        _pendingTimer.start(_pendingIntervalMs);
+    }
+}
+
+void PolarPlot::drawPendingProfiles()
+{
+    if (_pendingProfiles.isEmpty()) {
+        return;
+    }
+
+    // Profiles are applied in the received order, no angle of the batch is lost
+    for (const auto& pending : qAsConst(_pendingProfiles)) {
+        _distances.set(static_cast<int>(pending.angle) % maxGradian,
+            pending.profile.initialPoint() + pending.profile.length());
     }
 
+    const float maxDistance = _distances.max();
     if (maxDistance != _maxDistance) {
         _maxDistance = maxDistance;
         emit maxDistanceChanged();
     }
 
-    // The sensor can provide less than 1200 points, the scale factor will scale the samples if necessary
-    float scale = static_cast<float>(points.length()) / _image.height();
-    for (int angleRange = -angleGrad / 2.0f; angleRange <= angleGrad / 2.0f; angleRange++) {
-        // We know that the max and min angle range for ping360 is [0-400)
-        int newAngle = static_cast<int>(angle + angleRange + maxGradian) % maxGradian;
+    // The profiles are kept when the render queue is full, they are coalesced with the next ones
+    const bool queued = _renderer.tryRender([this, profiles = _pendingProfiles](QImage& image, QRegion& dirtyRegion) {
+        for (const auto& pending : profiles) {
+            drawProfile(image, dirtyRegion, pending);
+        }
+    });
+    if (!queued) {
+        _pendingTimer.start(_pendingIntervalMs);
+        return;
+    }
+    _pendingProfiles.clear();
+
+    emit imageChanged();
+}
+
+void PolarPlot::drawProfile(QImage& image, QRegion& dirtyRegion, const PendingProfile& pending)
+{
+    // Profiles with more samples than columns keep the strongest echo of each column
+    const QByteArray& profileSamples = pending.profile.samples();
+    _rowSamples.resize(image.width());
+    Decimation::resampleMax(reinterpret_cast<const uint8_t*>(profileSamples.constData()), profileSamples.size(),
+        _rowSamples.data(), image.width());
+
+    // The profile covers angleGrad gradians around its angle, the image can have more or less rows than gradians
+    const int rows = image.height();
+    const float rowsPerGradian = static_cast<float>(rows) / maxGradian;
+    const float centerRow = pending.angle * rowsPerGradian;
+    const float halfWidth = pending.angleGrad / 2.0f * rowsPerGradian;
+    const float halfSector = pending.sectorSizeGradian / 2.0f;
+
+    // All rows of the same profile share the same colors, the first one is drawn and copied to the others
+    const uchar* profileRow = nullptr;
+    for (int rowOffset = -halfWidth; rowOffset <= halfWidth; rowOffset++) {
+        const int row = static_cast<int>(centerRow + rowOffset + rows) % rows;
 
         // Check if we are inside the sector
-        if (newAngle > sectorSizeGradian / 2.0f && newAngle < maxGradian - sectorSizeGradian / 2.0f) {
+        const float rowAngle = row / rowsPerGradian;
+        if (rowAngle > halfSector && rowAngle < maxGradian - halfSector) {
             continue;
         }
 
-        for (int index = 0; index < _image.height(); index++) {
-            _image.setPixelColor(static_cast<int>(newAngle), index, valueToRGB(points[index * scale]));
+        if (!profileRow) {
+            drawRow(image, row, _rowSamples.constData(), image.width());
+            profileRow = image.constScanLine(row);
+        } else {
+            memcpy(image.scanLine(row), profileRow, image.bytesPerLine());
         }
+        dirtyRegion += QRect(0, row, image.width(), 1);
     }
-
-    // Fix max update in 20Hz at max
-    if (!_updateTimer.isActive()) {
-        _updateTimer.start(50);
-    }
-
-    emit imageChanged();
 }
 
 void PolarPlot::updateMouseColumnData()
@@ -146,3 +259,9 @@ void PolarPlot::updateMouseColumnData()
     emit mouseSampleAngleChanged();
     emit mouseSampleDistanceChanged();
 }
+
+PolarPlot::~PolarPlot()
+{
+    // The render jobs use the members of this class
+    _renderer.stop();
+}
@@ -1,10 +1,12 @@
 #pragma once
 
 #include <QImage>
-#include <QQuickPaintedItem>
+#include <QQuickItem>
 #include <QTimer>
 
 #include "logger.h"
+#include "maxsegmenttree.h"
+#include "profile.h"
 #include "ringvector.h"
 #include "waterfall.h"
 #include "waterfallgradient.h"
@@ -27,12 +29,10 @@ public:
     PolarPlot(QQuickItem* parent = nullptr);
 
     /**
-     * @brief This is used by the qml paint event
-     *  This paint the a polar waterfall in qml
+     * @brief Destroy the PolarPlot object
      *
-     * @param painter
      */
-    void paint(QPainter* painter) final override;
+    ~PolarPlot();
 
     /**
      * @brief Set the polar Image
@@ -42,17 +42,15 @@ public:
     void setImage(const QImage& image);
 
     /**
-     * @brief Draw a list of points in the waterfall
+     * @brief Draw a profile in the waterfall
+     *  Samples, angle, initial point and length of the profile are used.
+     *  Profiles received in the same frame interval are drawn together, a burst does a single render pass.
      *
-     * @param points
-     * @param angle
-     * @param initPoint
-     * @param length
-     * @param angleGrad
-     * @param sectorSize
+     * @param profile
+     * @param angleGrad angular width of the profile in gradians
+     * @param sectorSize in degrees
      */
-    Q_INVOKABLE void draw(
-        const QVector<double>& points, float angle, float initPoint, float length, float angleGrad, float sectorSize);
+    Q_INVOKABLE void draw(const Profile& profile, float angleGrad, float sectorSize);
 
     /**
      * @brief Clear waterfall and restart all parameters
@@ -65,7 +63,7 @@ public:
      *
      * @return QImage
      */
-    QImage image() { return _image; }
+    QImage image() { return _renderer.image(); }
     Q_PROPERTY(QImage image READ image WRITE setImage NOTIFY imageChanged)
 
     /**
@@ -92,29 +90,119 @@ public:
     float maxDistance() { return _maxDistance; }
     Q_PROPERTY(float maxDistance READ maxDistance NOTIFY maxDistanceChanged)
 
+    /**
+     * @brief Set the number of image rows used for a full turn, the image is cleared
+     *
+     * @param angularResolution
+     */
+    void setAngularResolution(int angularResolution);
+
+    /**
+     * @brief Return the number of image rows used for a full turn
+     *
+     * @return int
+     */
+    int angularResolution() const { return _angularResolution; }
+    Q_PROPERTY(int angularResolution READ angularResolution WRITE setAngularResolution NOTIFY angularResolutionChanged)
+
+    /**
+     * @brief Set the number of image columns used for the profile samples, the image is cleared
+     *  Profiles with more samples are decimated keeping the strongest echo of each column
+     *
+     * @param rangeResolution
+     */
+    void setRangeResolution(int rangeResolution);
+
+    /**
+     * @brief Return the number of image columns used for the profile samples
+     *
+     * @return int
+     */
+    int rangeResolution() const { return _rangeResolution; }
+    Q_PROPERTY(int rangeResolution READ rangeResolution WRITE setRangeResolution NOTIFY rangeResolutionChanged)
+
 signals:
+    void angularResolutionChanged();
     void imageChanged();
     void maxDistanceChanged();
     void mouseSampleAngleChanged();
     void mouseSampleDistanceChanged();
+    void rangeResolutionChanged();
     void sectorSizeDegreesChanged();
 
+protected:
+    /**
+     * @brief Return the full polar image, the polar transformation is done by the shader
+     *
+     * @param imageSize
+     * @return QVector<WaterfallNode::PaintRegion>
+     */
+    QVector<WaterfallNode::PaintRegion> paintRegions(const QSize& imageSize) const final override;
+
+    /**
+     * @brief Draw all pending profiles in a single render job
+     *  Distances and max distance are updated once for the entire batch
+     *
+     */
+    void drawPendingProfiles() final override;
+
+    /**
+     * @brief Do the polar transformation of the shader in the CPU
+     *  The disk radius has one pixel per range sample, angles without samples are transparent
+     *
+     * @param frame
+     * @return QImage
+     */
+    QImage frameToImage(const QImage& frame) const final override;
+
 private:
     Q_DISABLE_COPY(PolarPlot)
 
+    /**
+     * @brief Profile waiting to be drawn
+     *
+     */
+    struct PendingProfile {
+        Profile profile;
+        // Angle in gradians in the range [0, 400)
+        float angle;
+        float angleGrad;
+        float sectorSizeGradian;
+    };
+
+    /**
+     * @brief Draw the profile rows in the image, called from the render worker
+     *
+     * @param image
+     * @param dirtyRegion
+     * @param pending
+     */
+    void drawProfile(QImage& image, QRegion& dirtyRegion, const PendingProfile& pending);
+
+    /**
+     * @brief Create a new transparent image with the actual resolution
+     *
+     */
+    void resetImage();
+
     /**
      * @brief Update mouse column information
      *
      */
     void updateMouseColumnData();
 
-    QVector<float> _distances;
-    QImage _image;
+    int _angularResolution;
+    // Distance of each gradian, the max distance is updated in O(log n) for each profile
+    MaxSegmentTree<float> _distances;
     float _maxDistance;
     float _mouseSampleAngle;
     float _mouseSampleDistance;
-    QPainter* _painter;
+    QVector<PendingProfile> _pendingProfiles;
+    QTimer _pendingTimer;
+    int _rangeResolution;
+    // Hold the resampled row samples between draw calls, avoiding allocations, used by the render worker
+    QVector<uint8_t> _rowSamples;
     float _sectorSizeDegrees;
-    static uint16_t _angularResolution;
-    QTimer _updateTimer;
+    // Interval used to group the received profiles, about one frame
+    static const int _pendingIntervalMs = 16;
 };
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <deque>
+#include <functional>
+
+#include <QtGlobal>
+
+/**
+ * @brief Extremum (E.g: min or max) of the last values of a sequence
+ *  A monotonic deque is used, append and value are O(1) amortized, independent of the window size.
+ *  Only the values that can still be the extremum of the window are kept.
+ *
+ * @tparam T
+ * @tparam Compare std::less<T> for the minimum, std::greater<T> for the maximum
+ */
+template <typename T, typename Compare = std::less<T>> class SlidingWindowExtremum {
+public:
+    /**
+     * @brief Construct a new Sliding Window Extremum object
+     *
+     * @param windowSize number of values in the window
+     */
+    explicit SlidingWindowExtremum(int windowSize)
+        : _count(0)
+        , _windowSize(windowSize)
+    {
+    }
+
+    /**
+     * @brief Append a value, the oldest one leaves the window if it's full
+     *
+     * @param value
+     */
+    void append(const T& value)
+    {
+        // Older values that are not better than the new one can't be the extremum anymore
+        while (!_values.empty() && !_compare(_values.back().value, value)) {
+            _values.pop_back();
+        }
+        _values.push_back({_count, value});
+        _count++;
+
+        while (_values.front().index + _windowSize < _count) {
+            _values.pop_front();
+        }
+    }
+
+    /**
+     * @brief Remove all values and fill the window with the same value
+     *
+     * @param value
+     */
+    void fill(const T& value)
+    {
+        _values.clear();
+        _values.push_back({_count, value});
+        _count++;
+    }
+
+    /**
+     * @brief Return true if no value was appended
+     *
+     * @return true
+     * @return false
+     */
+    bool isEmpty() const { return _values.empty(); }
+
+    /**
+     * @brief Return the extremum of the window, it should not be empty
+     *
+     * @return const T&
+     */
+    const T& value() const
+    {
+        Q_ASSERT(!_values.empty());
+        return _values.front().value;
+    }
+
+    /**
+     * @brief Return the extremum that the window would have after appending a value, without appending it
+     *  It should not be empty
+     *
+     * @param value
+     * @return T
+     */
+    T valueWith(const T& value) const
+    {
+        Q_ASSERT(!_values.empty());
+        // Only the oldest value can leave the window with the next append
+        auto extremum = _values.cbegin();
+        if (extremum->index + _windowSize <= _count) {
+            extremum++;
+        }
+        return extremum != _values.cend() && _compare(extremum->value, value) ? extremum->value : value;
+    }
+
+    /**
+     * @brief Return the number of values in the window
+     *
+     * @return int
+     */
+    int windowSize() const { return _windowSize; }
+
+private:
+    struct Entry {
+        quint64 index;
+        T value;
+    };
+
+    Compare _compare;
+    // Number of appended values, used as index of the entries
+    quint64 _count;
+    // Sorted by index and by the extremum order, the front is the extremum
+    std::deque<Entry> _values;
+    int _windowSize;
+};
@@ -3,7 +3,10 @@
 
 #include <limits>
 
+#include <QMutexLocker>
 #include <QPainter>
+#include <QQuickWindow>
+#include <QRunnable>
 #include <QVector>
 #include <QtConcurrent>
 #include <QtMath>
@@ -52,16 +55,49 @@ QList<WaterfallGradient> Waterfall::_gradients {
         }},
 };
 
+namespace {
+/**
+ * @brief Delete the texture provider in the render thread
+ *
+ */
+class TextureProviderCleanupJob : public QRunnable {
+public:
+    TextureProviderCleanupJob(QSGTextureProvider* provider)
+        : _provider(provider)
+    {
+    }
+    void run() override { delete _provider; }
+
+private:
+    QSGTextureProvider* _provider;
+};
+}
+
 Waterfall::Waterfall(QQuickItem* parent)
-    : QQuickPaintedItem(parent)
+    : QQuickItem(parent)
+    , _colorTable()
     , _containsMouse(false)
     , _smooth(true)
+    , _textureProvider(nullptr)
 {
+    setFlag(ItemHasContents, true);
     setAntialiasing(_smooth);
     setAcceptedMouseButtons(Qt::AllButtons);
     setAcceptHoverEvents(true);
     setGradients();
     setTheme("Thermal blue");
+
+    connect(&_updateTimer, &QTimer::timeout, this, [&] { update(); });
+    _updateTimer.setSingleShot(true);
+    _updateTimer.start(50);
+
+    // Frames are published by the render worker thread
+    connect(&_renderer, &WaterfallRenderer::frameReady, this, [&] {
+        // Fix max update in 20Hz at max
+        if (!_updateTimer.isActive()) {
+            _updateTimer.start(50);
+        }
+    });
 }
 
 void Waterfall::setGradients()
@@ -101,6 +137,7 @@ void Waterfall::setTheme(const QString& theme)
         if (gradient.name() == theme) {
             _gradient = gradient;
             _theme = theme;
+            updateColorTable();
             emit themeChanged();
             return;
         }
@@ -108,7 +145,151 @@ void Waterfall::setTheme(const QString& theme)
     qCWarning(waterfall) << "Not valid theme:" << theme << " in:" << _themes;
 }
 
-QColor Waterfall::valueToRGB(float point) { return _gradient.getColor(point); }
+void Waterfall::updateColorTable()
+{
+    QMutexLocker locker(_renderer.jobMutex());
+    for (int i = 0; i < _colorTableSize; i++) {
+        const QColor color = _gradient.getColor(i / static_cast<float>(_colorTableSize - 1));
+        _colorTable[i] = qPremultiply(color.rgba());
+    }
+}
+
+QColor Waterfall::valueToRGB(float point) { return QColor::fromRgba(qUnpremultiply(valueToRGBA(point))); }
+
+void Waterfall::valuesToRGBA(const float* values, uint32_t* pixels, int length) const
+{
+    for (int i = 0; i < length; i++) {
+        pixels[i] = _colorTable[colorTableIndex(values[i])];
+    }
+}
+
+void Waterfall::drawColumn(QImage& image, int column, const float* values, int length, int offset) const
+{
+    Q_ASSERT(image.depth() == 32);
+    Q_ASSERT(column >= 0 && column < image.width());
+    Q_ASSERT(offset >= 0 && offset + length <= image.height());
+
+    // bits() detaches the image, it should be called only once per column
+    const int stride = image.bytesPerLine() / sizeof(uint32_t);
+    uint32_t* pixel = reinterpret_cast<uint32_t*>(image.bits()) + offset * stride + column;
+    for (int i = 0; i < length; i++, pixel += stride) {
+        *pixel = _colorTable[colorTableIndex(values[i])];
+    }
+}
+
+void Waterfall::drawRow(QImage& image, int row, const float* values, int length, int offset) const
+{
+    Q_ASSERT(image.depth() == 32);
+    Q_ASSERT(row >= 0 && row < image.height());
+    Q_ASSERT(offset >= 0 && offset + length <= image.width());
+
+    valuesToRGBA(values, reinterpret_cast<uint32_t*>(image.scanLine(row)) + offset, length);
+}
+
+void Waterfall::drawColumn(QImage& image, int column, const uint8_t* samples, int length, int offset) const
+{
+    Q_ASSERT(image.depth() == 32);
+    Q_ASSERT(column >= 0 && column < image.width());
+    Q_ASSERT(offset >= 0 && offset + length <= image.height());
+
+    const int stride = image.bytesPerLine() / sizeof(uint32_t);
+    uint32_t* pixel = reinterpret_cast<uint32_t*>(image.bits()) + offset * stride + column;
+    for (int i = 0; i < length; i++, pixel += stride) {
+        *pixel = _colorTable[samples[i]];
+    }
+}
+
+void Waterfall::drawRow(QImage& image, int row, const uint8_t* samples, int length, int offset) const
+{
+    Q_ASSERT(image.depth() == 32);
+    Q_ASSERT(row >= 0 && row < image.height());
+    Q_ASSERT(offset >= 0 && offset + length <= image.width());
+
+    uint32_t* pixel = reinterpret_cast<uint32_t*>(image.scanLine(row)) + offset;
+    for (int i = 0; i < length; i++) {
+        pixel[i] = _colorTable[samples[i]];
+    }
+}
+
+QSGNode* Waterfall::updatePaintNode(QSGNode* oldNode, UpdatePaintNodeData*)
+{
+    auto node = static_cast<WaterfallNode*>(oldNode);
+    // The render worker can't swap the frame while it's uploaded
+    _renderer.readFrame([&](const QImage& image, const QRegion& dirtyRegion) {
+        if (image.isNull()) {
+            delete node;
+            node = nullptr;
+            return;
+        }
+
+        if (!node) {
+            node = new WaterfallNode();
+            node->updateTexture(window(), image, image.rect());
+        } else {
+            node->updateTexture(window(), image, dirtyRegion);
+        }
+        node->setPaintRegions(paintRegions(image.size()));
+    });
+
+    if (node && _textureProvider) {
+        _textureProvider->setTexture(node->texture());
+    }
+
+    return node;
+}
+
+QSGTextureProvider* Waterfall::textureProvider() const
+{
+    if (!_textureProvider) {
+        _textureProvider = new WaterfallTextureProvider();
+    }
+    return _textureProvider;
+}
+
+void Waterfall::releaseResources()
+{
+    if (_textureProvider) {
+        window()->scheduleRenderJob(new TextureProviderCleanupJob(_textureProvider), QQuickWindow::NoStage);
+        _textureProvider = nullptr;
+    }
+}
+
+Waterfall::~Waterfall()
+{
+    if (window()) {
+        releaseResources();
+    }
+}
+
+QImage Waterfall::grabImage()
+{
+    drawPendingProfiles();
+    _renderer.waitForIdle();
+
+    const QImage frame = _renderer.image();
+    if (frame.isNull()) {
+        return {};
+    }
+
+    if (width() <= 0 || height() <= 0) {
+        setSize(frame.size());
+    }
+    return frameToImage(frame);
+}
+
+QImage Waterfall::frameToImage(const QImage& frame) const
+{
+    QImage image(size().toSize(), QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::transparent);
+
+    QPainter painter(&image);
+    // Same linear filtering of the scene graph texture
+    painter.setRenderHint(QPainter::SmoothPixmapTransform);
+    for (const auto& region : paintRegions(frame.size())) {
+        painter.drawImage(region.target, frame, region.source);
+    }
+    return image;
+}
 
 float Waterfall::RGBToValue(const QColor& color) { return _gradient.getValue(color); }
 
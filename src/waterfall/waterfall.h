@@ -1,11 +1,17 @@
 #pragma once
 
+#include <array>
+
 #include <QImage>
-#include <QQuickPaintedItem>
+#include <QQuickItem>
+#include <QRegion>
+#include <QTimer>
 
 #include "logger.h"
 #include "ringvector.h"
 #include "waterfallgradient.h"
+#include "waterfallnode.h"
+#include "waterfallrenderer.h"
 
 Q_DECLARE_LOGGING_CATEGORY(waterfall)
 
@@ -13,7 +19,7 @@ Q_DECLARE_LOGGING_CATEGORY(waterfall)
  * @brief Waterfall widget
  *
  */
-class Waterfall : public QQuickPaintedItem {
+class Waterfall : public QQuickItem {
     Q_OBJECT
 public:
     /**
@@ -24,12 +30,25 @@ public:
     Waterfall(QQuickItem* parent = nullptr);
 
     /**
-     * @brief This is used by the qml pain event
-     *  This paint the waterfall in qml
+     * @brief Destroy the Waterfall object
+     *
+     */
+    ~Waterfall();
+
+    /**
+     * @brief Waterfalls can be used as texture source by shader effects
+     *
+     * @return true
+     */
+    bool isTextureProvider() const override { return true; }
+
+    /**
+     * @brief Return the texture provider with the waterfall image
+     *  This is called from the render thread
      *
-     * @param painter
+     * @return QSGTextureProvider*
      */
-    virtual void paint(QPainter* painter) = 0;
+    QSGTextureProvider* textureProvider() const override;
 
     /**
      * @brief Change the theme used in the waterfall
@@ -46,6 +65,73 @@ public:
      */
     QColor valueToRGB(float point);
 
+    /**
+     * @brief Transform a power value 0-1 to a premultiplied ARGB32 pixel
+     *  The value is quantized to the color lookup table resolution
+     *
+     * @param point
+     * @return QRgb
+     */
+    QRgb valueToRGBA(float point) const { return _colorTable[colorTableIndex(point)]; }
+
+    /**
+     * @brief Transform a list of power values 0-1 to premultiplied ARGB32 pixels
+     *  This should be used by the plots instead of valueToRGB, since it avoids QColor construction for each sample
+     *
+     * @param values
+     * @param pixels output buffer, it should be able to hold length pixels
+     * @param length
+     */
+    void valuesToRGBA(const float* values, uint32_t* pixels, int length) const;
+
+    /**
+     * @brief Write a list of power values 0-1 as colors in a column of a 32 bits image
+     *  The pixels are written directly in the image buffer, without format conversion or bounds checks
+     *
+     * @param image
+     * @param column
+     * @param values
+     * @param length
+     * @param offset first row to be written
+     */
+    void drawColumn(QImage& image, int column, const float* values, int length, int offset = 0) const;
+
+    /**
+     * @brief Write a list of power values 0-1 as colors in a row of a 32 bits image
+     *  The pixels are written directly in the image scan line, without format conversion or bounds checks
+     *
+     * @param image
+     * @param row
+     * @param values
+     * @param length
+     * @param offset first column to be written
+     */
+    void drawRow(QImage& image, int row, const float* values, int length, int offset = 0) const;
+
+    /**
+     * @brief Write a list of 8 bits power samples (0-255) as colors in a column of a 32 bits image
+     *  The samples are used directly as color lookup table indexes, without normalization
+     *
+     * @param image
+     * @param column
+     * @param samples
+     * @param length
+     * @param offset first row to be written
+     */
+    void drawColumn(QImage& image, int column, const uint8_t* samples, int length, int offset = 0) const;
+
+    /**
+     * @brief Write a list of 8 bits power samples (0-255) as colors in a row of a 32 bits image
+     *  The samples are used directly as color lookup table indexes, without normalization
+     *
+     * @param image
+     * @param row
+     * @param samples
+     * @param length
+     * @param offset first column to be written
+     */
+    void drawRow(QImage& image, int row, const uint8_t* samples, int length, int offset = 0) const;
+
     /**
      * @brief Transform color to a power value
      *
@@ -81,6 +167,15 @@ public:
      */
     virtual Q_INVOKABLE void clear() = 0;
 
+    /**
+     * @brief Draw the waiting profiles and return the image shown by the item
+     *  It does not need a window or a scene graph, E.g: to save the plot of a log without the user interface.
+     *  Items without size take the size of the renderer frame
+     *
+     * @return QImage
+     */
+    QImage grabImage();
+
     /**
      * @brief Return mouse position
      *
@@ -167,6 +262,69 @@ signals:
     void smoothChanged();
 
 protected:
+    /**
+     * @brief Update the scene graph node with the last frame of the renderer
+     *  Only the dirty region of the image is uploaded to the GPU when possible
+     *
+     * @param oldNode
+     * @return QSGNode*
+     */
+    QSGNode* updatePaintNode(QSGNode* oldNode, UpdatePaintNodeData*) override;
+
+    /**
+     * @brief Release the texture provider when the item is removed from the window
+     *
+     */
+    void releaseResources() override;
+
+    /**
+     * @brief Return the parts of the image that should be drawn in the item
+     *  This is called from the render thread while the GUI thread is blocked and the renderer frame can't change
+     *
+     * @param imageSize size of the frame
+     * @return QVector<WaterfallNode::PaintRegion>
+     */
+    virtual QVector<WaterfallNode::PaintRegion> paintRegions(const QSize& imageSize) const = 0;
+
+    /**
+     * @brief Draw the profiles that are waiting to be drawn in a batch
+     *
+     */
+    virtual void drawPendingProfiles() {}
+
+    /**
+     * @brief Transform a renderer frame in the image shown by the item
+     *  The default implementation draws the paint regions of the frame with the item size
+     *
+     * @param frame
+     * @return QImage
+     */
+    virtual QImage frameToImage(const QImage& frame) const;
+
+    /**
+     * @brief Return the color lookup table index of a power value 0-1
+     *  Values outside of the valid range are clamped, NaN values are mapped to the first color
+     *
+     * @param point
+     * @return int
+     */
+    static int colorTableIndex(float point)
+    {
+        if (!(point > 0)) {
+            return 0;
+        }
+        if (point >= 1) {
+            return _colorTableSize - 1;
+        }
+        return static_cast<int>(point * (_colorTableSize - 1) + 0.5f);
+    }
+
+    // Sensors provide 8 bits samples, a bigger table would not add any visible information
+    // 8 bits samples are color table indexes
+    static constexpr int _colorTableSize = 256;
+    // Used by the render jobs, it should only change with the renderer job mutex locked
+    std::array<QRgb, _colorTableSize> _colorTable;
+
     bool _containsMouse;
     WaterfallGradient _gradient;
     static QList<WaterfallGradient> _gradients;
@@ -174,6 +332,9 @@ protected:
     bool _smooth;
     QString _theme;
     QStringList _themes;
+    // Rasterizes the image out of the GUI thread, subclasses should stop it in their destructors
+    WaterfallRenderer _renderer;
+    QTimer _updateTimer;
 
 private:
     Q_DISABLE_COPY(Waterfall)
@@ -189,4 +350,13 @@ private:
      *
      */
     void loadUserGradients();
+
+    /**
+     * @brief Populate the color lookup table with the actual gradient
+     *
+     */
+    void updateColorTable();
+
+    // Created and used in the render thread
+    mutable WaterfallTextureProvider* _textureProvider;
 };
@@ -0,0 +1,139 @@
+#include <QOpenGLContext>
+#include <QQuickWindow>
+#include <QSGRendererInterface>
+#include <QSGSimpleTextureNode>
+
+#include "waterfallnode.h"
+
+PING_LOGGING_CATEGORY(waterfallnode, "ping.waterfallnode")
+
+// Not available in OpenGL ES headers, it has the same value of GL_BGRA_EXT
+#ifndef GL_BGRA
+#define GL_BGRA 0x80E1
+#endif
+
+WaterfallTexture::WaterfallTexture()
+    : _bgraSupported(false)
+    , _textureId(0)
+{
+}
+
+void WaterfallTexture::upload(const QImage& image, const QRegion& dirtyRegion)
+{
+    if (!_textureId) {
+        initializeOpenGLFunctions();
+        glGenTextures(1, &_textureId);
+
+        const auto context = QOpenGLContext::currentContext();
+        _bgraSupported = Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+            && (!context->isOpenGLES() || context->hasExtension(QByteArrayLiteral("GL_EXT_texture_format_BGRA8888")));
+        qCDebug(waterfallnode) << "Texture created, BGRA upload support:" << _bgraSupported;
+    }
+
+    glBindTexture(GL_TEXTURE_2D, _textureId);
+
+    // Allocate the texture storage and do a full upload
+    if (_size != image.size()) {
+        _size = image.size();
+        // OpenGL ES requires the same internal format and format
+        const bool isOpenGLES = QOpenGLContext::currentContext()->isOpenGLES();
+        const GLint internalFormat = _bgraSupported && isOpenGLES ? GL_BGRA : GL_RGBA;
+        glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, _size.width(), _size.height(), 0,
+            _bgraSupported ? GL_BGRA : GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        updateBindOptions(true);
+        uploadRect(image, image.rect());
+        return;
+    }
+
+    for (const QRect& rect : dirtyRegion) {
+        uploadRect(image, rect.intersected(image.rect()));
+    }
+}
+
+void WaterfallTexture::uploadRect(const QImage& image, const QRect& rect)
+{
+    if (rect.isEmpty()) {
+        return;
+    }
+
+    // OpenGL ES 2 does not support GL_UNPACK_ROW_LENGTH, the uploaded rows need to be contiguous in memory.
+    // Full width rectangles are used directly from the image buffer, partial ones are small (E.g: columns) and copied.
+    QImage subImage = rect.width() == image.width()
+        ? QImage(image.constScanLine(rect.y()), rect.width(), rect.height(), image.bytesPerLine(), image.format())
+        : image.copy(rect);
+    if (!_bgraSupported) {
+        subImage = subImage.convertToFormat(QImage::Format_RGBA8888_Premultiplied);
+    }
+
+    glTexSubImage2D(GL_TEXTURE_2D, 0, rect.x(), rect.y(), rect.width(), rect.height(),
+        _bgraSupported ? GL_BGRA : GL_RGBA, GL_UNSIGNED_BYTE, subImage.constBits());
+}
+
+void WaterfallTexture::bind()
+{
+    glBindTexture(GL_TEXTURE_2D, _textureId);
+    updateBindOptions();
+}
+
+WaterfallTexture::~WaterfallTexture()
+{
+    // Textures are deleted by the scene graph in the render thread, where the context is current
+    if (_textureId && QOpenGLContext::currentContext()) {
+        glDeleteTextures(1, &_textureId);
+    }
+}
+
+void WaterfallNode::updateTexture(QQuickWindow* window, const QImage& image, const QRegion& dirtyRegion)
+{
+    if (window->rendererInterface()->graphicsApi() == QSGRendererInterface::OpenGL) {
+        auto texture = qobject_cast<WaterfallTexture*>(_texture.data());
+        if (!texture) {
+            texture = new WaterfallTexture();
+            texture->setFiltering(QSGTexture::Linear);
+            _texture.reset(texture);
+        }
+        texture->upload(image, dirtyRegion);
+        return;
+    }
+
+    // There is no public API to do partial updates with the other backends (E.g: software)
+    if (_texture && dirtyRegion.isEmpty()) {
+        return;
+    }
+    _texture.reset(window->createTextureFromImage(image));
+    _texture->setFiltering(QSGTexture::Linear);
+}
+
+void WaterfallNode::setPaintRegions(const QVector<PaintRegion>& paintRegions)
+{
+    // Match the number of texture nodes with the number of regions
+    while (childCount() > paintRegions.size()) {
+        auto node = lastChild();
+        removeChildNode(node);
+        delete node;
+    }
+    while (childCount() < paintRegions.size()) {
+        auto node = new QSGSimpleTextureNode();
+        node->setFiltering(QSGTexture::Linear);
+        appendChildNode(node);
+    }
+
+    for (int i = 0; i < paintRegions.size(); i++) {
+        auto node = static_cast<QSGSimpleTextureNode*>(childAtIndex(i));
+        // The texture can be created again by the non OpenGL backends
+        if (node->texture() != _texture.data()) {
+            node->setTexture(_texture.data());
+        }
+        node->setRect(paintRegions[i].target);
+        node->setSourceRect(paintRegions[i].source);
+    }
+}
+
+WaterfallNode::~WaterfallNode()
+{
+    // Texture nodes should not outlive the texture
+    while (auto node = firstChild()) {
+        removeChildNode(node);
+        delete node;
+    }
+}
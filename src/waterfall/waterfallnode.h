@@ -0,0 +1,189 @@
+#pragma once
+
+#include <QImage>
+#include <QOpenGLFunctions>
+#include <QRegion>
+#include <QSGNode>
+#include <QSGTexture>
+#include <QSGTextureProvider>
+#include <QScopedPointer>
+#include <QVector>
+
+#include "logger.h"
+
+Q_DECLARE_LOGGING_CATEGORY(waterfallnode)
+
+class QQuickWindow;
+
+/**
+ * @brief Persistent OpenGL texture that supports partial updates
+ *  The texture should be updated only from the render thread, while the GUI thread is blocked,
+ *  E.g: QQuickItem::updatePaintNode
+ *
+ */
+class WaterfallTexture : public QSGTexture, protected QOpenGLFunctions {
+    Q_OBJECT
+public:
+    /**
+     * @brief Construct a new Waterfall Texture object
+     *
+     */
+    WaterfallTexture();
+
+    /**
+     * @brief Destroy the Waterfall Texture object
+     *
+     */
+    ~WaterfallTexture();
+
+    /**
+     * @brief Upload the dirty region of the image to the texture
+     *  The full image is uploaded if the texture size does not match the image size
+     *
+     * @param image
+     * @param dirtyRegion
+     */
+    void upload(const QImage& image, const QRegion& dirtyRegion);
+
+    /**
+     * @brief Bind the texture in the current OpenGL context
+     *
+     */
+    void bind() final override;
+
+    /**
+     * @brief Waterfall images are always transparent
+     *
+     * @return true
+     */
+    bool hasAlphaChannel() const final override { return true; }
+
+    /**
+     * @brief Waterfall images does not use mipmaps
+     *
+     * @return false
+     */
+    bool hasMipmaps() const final override { return false; }
+
+    /**
+     * @brief Return the OpenGL texture id
+     *
+     * @return int
+     */
+    int textureId() const final override { return static_cast<int>(_textureId); }
+
+    /**
+     * @brief Return the texture size in pixels
+     *
+     * @return QSize
+     */
+    QSize textureSize() const final override { return _size; }
+
+private:
+    Q_DISABLE_COPY(WaterfallTexture)
+
+    /**
+     * @brief Upload a rectangle of the image to the texture
+     *
+     * @param image
+     * @param rect
+     */
+    void uploadRect(const QImage& image, const QRect& rect);
+
+    // BGRA allows ARGB32 images to be uploaded without conversion in little endian machines
+    bool _bgraSupported;
+    QSize _size;
+    GLuint _textureId;
+};
+
+/**
+ * @brief Scene graph node used by the waterfalls
+ *  It holds a single texture with the waterfall image and a texture node for each part of the image that is drawn
+ *
+ */
+class WaterfallNode : public QSGNode {
+public:
+    /**
+     * @brief Part of the image that should be drawn in the item
+     *
+     */
+    struct PaintRegion {
+        // Rectangle in item coordinates
+        QRectF target;
+        // Rectangle in image pixels
+        QRectF source;
+    };
+
+    /**
+     * @brief Construct a new Waterfall Node object
+     *
+     */
+    WaterfallNode() = default;
+
+    /**
+     * @brief Destroy the Waterfall Node object
+     *
+     */
+    ~WaterfallNode();
+
+    /**
+     * @brief Update the texture with the changed parts of the image
+     *  With the OpenGL backend only the dirty region is uploaded,
+     *  the other backends (E.g: software) create the texture again if anything changed.
+     *
+     * @param window
+     * @param image
+     * @param dirtyRegion
+     */
+    void updateTexture(QQuickWindow* window, const QImage& image, const QRegion& dirtyRegion);
+
+    /**
+     * @brief Set the parts of the texture that should be drawn
+     *
+     * @param paintRegions
+     */
+    void setPaintRegions(const QVector<PaintRegion>& paintRegions);
+
+    /**
+     * @brief Return the texture with the waterfall image
+     *
+     * @return QSGTexture*
+     */
+    QSGTexture* texture() const { return _texture.data(); }
+
+private:
+    Q_DISABLE_COPY(WaterfallNode)
+
+    QScopedPointer<QSGTexture> _texture;
+};
+
+/**
+ * @brief Texture provider used to share the waterfall texture with shader effects
+ *  E.g: Ping360 polar shader
+ *
+ */
+class WaterfallTextureProvider : public QSGTextureProvider {
+    Q_OBJECT
+public:
+    /**
+     * @brief Return the actual texture
+     *
+     * @return QSGTexture*
+     */
+    QSGTexture* texture() const final override { return _texture; }
+
+    /**
+     * @brief Set the texture and notify the consumers
+     *  The texture is owned by the WaterfallNode
+     *
+     * @param texture
+     */
+    void setTexture(QSGTexture* texture)
+    {
+        _texture = texture;
+        emit textureChanged();
+    }
+
+private:
+    QSGTexture* _texture = nullptr;
+};
@@ -1,9 +1,9 @@
 #include "waterfallplot.h"
 #include "filemanager.h"
 
+#include <cstring>
 #include <limits>
 
-#include <QPainter>
 #include <QVector>
 #include <QtConcurrent>
 #include <QtMath>
@@ -15,24 +15,33 @@ uint16_t WaterfallPlot::_displayWidth = 500;
 
 WaterfallPlot::WaterfallPlot(QQuickItem* parent)
     : Waterfall(parent)
-    , _currentDrawIndex(_displayWidth)
-    , _image(2048, 3500, QImage::Format_RGBA8888)
+    , _dynamicPixelsPerMeterScalar(1)
+    , _inDynamic(false)
     , _maxDepthToDrawInPixels(0)
+    , _maxDepthWindow(_displayWidth)
     , _minDepthToDrawInPixels(0)
+    , _minDepthWindow(_displayWidth)
     , _mouseDepth(0)
-    , _painter(nullptr)
-    , _updateTimer(new QTimer(this))
+    , _columnProfiles(_displayWidth)
+    , _frameDrawIndex(0)
 {
+    // The visible window is published by the worker with the frame that contains it
+    _renderer.setPublishFunction([this] {
+        _frameWindow = _renderedWindow;
+        _frameDrawIndex = _renderedWindow.drawIndex;
+    });
+
+    // Ring buffer with one column for each displayed sample
+    QImage image(_displayWidth, 3500, QImage::Format_ARGB32_Premultiplied);
+    image.fill(QColor(Qt::transparent));
+    _renderer.setImage(image);
     // This is the max depth that ping returns
     setMaxDepth(200);
-    _DCRing.fill({static_cast<float>(_image.height()), 0, 0, 0}, _displayWidth);
+    _DCRing.fill({static_cast<float>(image.height()), 0, 0, 0}, _displayWidth);
+    _maxDepthWindow.fill(0);
+    _minDepthWindow.fill(image.height());
     setAcceptedMouseButtons(Qt::AllButtons);
     setAcceptHoverEvents(true);
-    _image.fill(QColor(Qt::transparent));
-
-    connect(_updateTimer, &QTimer::timeout, this, [&] { update(); });
-    _updateTimer->setSingleShot(true);
-    _updateTimer->start(50);
 
     connect(this, &Waterfall::mousePosChanged, this, &WaterfallPlot::updateMouseColumnData);
 }
@@ -40,35 +49,40 @@ WaterfallPlot::WaterfallPlot(QQuickItem* parent)
 void WaterfallPlot::setMaxDepth(float maxDepth)
 {
     _waterfallDepth = maxDepth;
-    _minPixelsPerMeter = _image.height() / _waterfallDepth;
+    _minPixelsPerMeter = _renderer.imageSize().height() / _waterfallDepth;
 }
 
-void WaterfallPlot::paint(QPainter* painter)
+QVector<WaterfallNode::PaintRegion> WaterfallPlot::paintRegions(const QSize& imageSize) const
 {
-    static QPixmap pix;
-    if (painter != _painter) {
-        _painter = painter;
-    }
-
-    static uint16_t first;
-
-    if (_currentDrawIndex < _displayWidth) {
-        first = 0;
-    } else {
-        first = _currentDrawIndex - _displayWidth;
+    /**
+     * The image is a ring buffer where the oldest column is the next one to be written.
+     * The visible window is drawn in two parts, from the oldest column to the end of the image
+     * and from the beginning of the image to the newest column.
+     */
+    const auto& visible = _frameWindow;
+    const int tailWidth = imageSize.width() - visible.drawIndex;
+    const qreal tailTargetWidth = width() * tailWidth / imageSize.width();
+    QVector<WaterfallNode::PaintRegion> regions {
+        {QRectF(0, 0, tailTargetWidth, height()),
+            QRectF(visible.drawIndex, visible.minDepthInPixels, tailWidth, visible.maxDepthInPixels)},
+    };
+    if (visible.drawIndex > 0) {
+        regions.append({QRectF(tailTargetWidth, 0, width() - tailTargetWidth, height()),
+            QRectF(0, visible.minDepthInPixels, visible.drawIndex, visible.maxDepthInPixels)});
     }
-
-    // http://blog.qt.io/blog/2006/05/13/fast-transformed-pixmapimage-drawing/
-    pix = QPixmap::fromImage(_image, Qt::NoFormatConversion);
-    // Code for debug, draw the entire waterfall
-    //_painter->drawPixmap(_painter->viewport(), pix, QRect(0, 0, _image.width(), _image.height()));
-    _painter->drawPixmap(QRect(0, 0, width(), height()), pix,
-        QRect(first, _minDepthToDrawInPixels, _displayWidth, _maxDepthToDrawInPixels));
+    return regions;
 }
 
 void WaterfallPlot::setImage(const QImage& image)
 {
-    _image = image;
+    _renderer.setImage(image);
+    const VisibleWindow visible = visibleWindow();
+    _renderer.render([this, visible](QImage& renderImage, QRegion& dirtyRegion) {
+        _columnProfiles.fill({}, renderImage.width());
+        // The new image is written from the first column
+        _renderedWindow = {0, visible.minDepthInPixels, visible.maxDepthInPixels};
+        dirtyRegion += renderImage.rect();
+    });
     emit imageChanged();
     setImplicitWidth(image.width());
     setImplicitHeight(image.height());
@@ -80,21 +94,34 @@ void WaterfallPlot::clear()
     _maxDepthToDrawInPixels = 0;
     _minDepthToDrawInPixels = 0;
     _mouseDepth = 0;
-    _DCRing.fill({static_cast<float>(_image.height()), 0, 0, 0}, _displayWidth);
-    _image.fill(Qt::transparent);
+    _DCRing.fill({static_cast<float>(_renderer.imageSize().height()), 0, 0, 0}, _displayWidth);
+    _maxDepthWindow.fill(0);
+    _minDepthWindow.fill(_renderer.imageSize().height());
+    const VisibleWindow visible = visibleWindow();
+    _renderer.render([this, visible](QImage& image, QRegion& dirtyRegion) {
+        _columnProfiles.fill({}, image.width());
+        image.fill(Qt::transparent);
+        dirtyRegion += image.rect();
+        _renderedWindow = {_renderedWindow.drawIndex, visible.minDepthInPixels, visible.maxDepthInPixels};
+    });
 }
 
-void WaterfallPlot::draw(const QVector<double>& points, float confidence, float initPoint, float length, float distance)
+void WaterfallPlot::draw(const Profile& profile)
 {
+    const float confidence = profile.confidence();
+    const float initPoint = profile.initialPoint();
+    const float length = profile.length();
+    const float distance = profile.distance();
+
     /*
         initPoint: The lowest point of the last sample in meters
         length: The length of the last sample in meters
         _minPixelsPerMeter: waterfall max pixel height divided by max depth
             _minPixelsPerMeter = _image.height()/_waterfallDepth;
-        lastMaxDC: Returns the last DC structure with max depth
-        lastMinDepth: Returns the minimum point in the chart
-        _minDepthToDraw: Minimum depth point, populated by lastMinDepth
-        _maxDepthToDraw: Maximum depth point, calculated from lastMaxDC
+        _maxDepthWindow: Max depth (initPoint + length) of the last n samples
+        _minDepthWindow: Min initPoint of the last n samples
+        _minDepthToDraw: Minimum depth point, populated by _minDepthWindow
+        _maxDepthToDraw: Maximum depth point, populated by _maxDepthWindow
         dynamicPixelsPerMeterScalar: Calculate the delta between number of pixels per meter
             dynamicPixelsPerMeterScalar = 400/((_maxDepthToDraw - _minDepthToDraw)*_minPixelsPerMeter);
 
@@ -129,169 +156,178 @@ void WaterfallPlot::draw(const QVector<double>& points, float confidence, float
             virtualHeight = ((length + initPoint - _minDepthToDraw)*_minPixelsPerMeter*dynamicPixelsPerMeterScalar);
     */
 
-    // Declare oldImage variable to do image spins
-    static QImage old = _image;
-    // Declare oldPoints variable to do some filter
-    static QVector<double> oldPoints = points;
-
-    // This ring vector will store variables of the last n samples for user access
-    _DCRing.append({initPoint, length, confidence, distance});
-
-    /**
-     * @brief Get lastMaxDepth from the last n samples
-     */
-    auto lastMaxDC = [&] {
-        float maxDepth = 0;
-        DCPack tempDC {0, 0, 0, 0};
-        for (const auto& DC : qAsConst(_DCRing)) {
-            if (maxDepth < DC.length + DC.initialDepth && DC.initialDepth != static_cast<float>(_image.height())) {
-                maxDepth = DC.length + DC.initialDepth;
-                tempDC = DC;
-            }
-        }
-        return tempDC;
-    };
-
-    /**
-     * @brief Get lastMinDepth from the last n samples
-     */
-    auto lastMinDepth = [&] {
-        float minDepth = std::numeric_limits<float>::max();
-        for (const auto& DC : qAsConst(_DCRing)) {
-            minDepth = minDepth > DC.initialDepth ? DC.initialDepth : minDepth;
-        }
-        return minDepth;
-    };
-
-    /**
-     * @brief Do a fast scale of image, but without changing the default size
-     *
-     * dst is the rectangle that will be used to draw old in `image`.
-     * src is the rectangle that will be used as source to be drawed in `image`,
-     *        the default value is old.rect().
-     *
-     */
-    auto redrawImage = [&](const QRect& dst, QRect src = QRect()) {
-        // Use old as default rect
-        if (src.isEmpty()) {
-            src = old.rect();
-        }
-
-        // Swap is faster
-        _image.swap(old);
-        _image.fill(Qt::transparent);
-        QPainter painter(&_image);
-        // Clean everything and start from zero
-        painter.fillRect(_image.rect(), Qt::transparent);
-        // QRect(0, 0, _image.width(), _image.height()*dynamicPixelsPerMeterScalar), old
-        painter.drawImage(dst, old, src);
-        painter.end();
-    };
-
-    static DCPack _maxDC;
-    _maxDC = lastMaxDC();
-    _minDepthToDraw = lastMinDepth();
-    _maxDepthToDraw = _maxDC.initialDepth + _maxDC.length;
+    // Min and max depth of the last n samples, the initial depth of empty samples is the image height
+    // The windows follow the drawn columns, the profile is only appended to them when its column is queued
+    const float imageHeight = _renderer.imageSize().height();
+    const float maxDepth = initPoint != imageHeight ? initPoint + length : 0;
+    _minDepthToDraw = _minDepthWindow.valueWith(initPoint);
+    _maxDepthToDraw = _maxDepthWindow.valueWith(maxDepth);
     emit minDepthToDrawChanged();
     emit maxDepthToDrawChanged();
 
-    static bool inDynamic = false;
-    static float dynamicPixelsPerMeterScalar = 1.0;
     // If the points/resolution is **NOT** bigger than 1pixel/point
     if ((_maxDepthToDraw - _minDepthToDraw) * _minPixelsPerMeter < 200) {
-        if (!inDynamic) {
-            inDynamic = true;
-            dynamicPixelsPerMeterScalar = 200 / _minPixelsPerMeter;
-            redrawImage(QRect(0, 0, _image.width(), _image.height() * dynamicPixelsPerMeterScalar));
+        if (!_inDynamic) {
+            _inDynamic = true;
+            _dynamicPixelsPerMeterScalar = 200 / _minPixelsPerMeter;
+            rebuildColumns();
         }
     } else {
         // If the points/resolution is bigger than 1pixel/point
-        if (inDynamic) {
-            redrawImage(QRect(0, 0, _image.width(), _image.height() / dynamicPixelsPerMeterScalar));
+        if (_inDynamic) {
+            _inDynamic = false;
+            _dynamicPixelsPerMeterScalar = 1;
+            rebuildColumns();
         }
-        inDynamic = false;
-        dynamicPixelsPerMeterScalar = 1;
     }
     _minDepthToDrawInPixels = _minDepthToDraw * _minPixelsPerMeter;
-    _maxDepthToDrawInPixels = (_maxDepthToDraw - _minDepthToDraw) * _minPixelsPerMeter * dynamicPixelsPerMeterScalar;
-    int virtualFloor = initPoint * _minPixelsPerMeter;
-    int virtualHeight = length * _minPixelsPerMeter * dynamicPixelsPerMeterScalar;
-
-    // Copy tail to head
-    // TODO: can we get even better and allocate just once at initialization? ie circular buffering
-    if (_currentDrawIndex >= _image.width()) {
-        redrawImage(QRect(0, 0, _displayWidth, _image.height()),
-            QRect(old.width() - _displayWidth, 0, _displayWidth, old.height()));
-
-        // Start painting from the beginning
-        _currentDrawIndex = _displayWidth;
+    _maxDepthToDrawInPixels = (_maxDepthToDraw - _minDepthToDraw) * _minPixelsPerMeter * _dynamicPixelsPerMeterScalar;
+
+    int virtualFloor = 0;
+    int virtualHeight = 0;
+    bool queued = false;
+    if (columnRows(depthScale(), initPoint, length, profile.samples().size(), virtualFloor, virtualHeight)) {
+        // The profile is shared with the worker, the samples are not copied
+        const bool smoothProfile = smooth();
+        const VisibleWindow visible = visibleWindow();
+        queued = _renderer.tryRender(
+            [this, profile, smoothProfile, virtualFloor, virtualHeight, visible](QImage& image, QRegion& dirtyRegion) {
+                // The newest column overwrites the oldest one, the worker keeps the index since draws can be dropped
+                const int column = _renderedWindow.drawIndex;
+                updateIncomingProfile(profile, smoothProfile);
+                drawProfileColumn(image, dirtyRegion, column, _incomingProfile, virtualFloor, virtualHeight);
+                // Swap to reuse the memory of the oldest profile in the next call
+                std::swap(_columnProfiles[column], _incomingProfile);
+                _renderedWindow = {(column + 1) % image.width(), visible.minDepthInPixels, visible.maxDepthInPixels};
+            });
+    }
+
+    // This ring vector will store variables of the last n samples for user access, it follows the drawn columns
+    if (queued) {
+        _DCRing.append({initPoint, length, confidence, distance});
+        _maxDepthWindow.append(maxDepth);
+        _minDepthWindow.append(initPoint);
+        return;
     }
 
+    // The profile was not drawn, the next profile scale is checked again without it
+    _minDepthToDraw = _minDepthWindow.value();
+    _maxDepthToDraw = _maxDepthWindow.value();
+    emit minDepthToDrawChanged();
+    emit maxDepthToDrawChanged();
+}
+
+void WaterfallPlot::updateIncomingProfile(const Profile& profile, bool smooth)
+{
+    // The profile samples have the same resolution of the color lookup table, they are kept without conversion
+    const QByteArray& profileSamples = profile.samples();
+    const int numberOfSamples = profileSamples.size();
+    const auto samples = reinterpret_cast<const uint8_t*>(profileSamples.constData());
+    _incomingProfile.initialDepth = profile.initialPoint();
+    _incomingProfile.length = profile.length();
+    _incomingProfile.samples.resize(numberOfSamples);
+    if (smooth) {
+        // The filter starts again when the number of samples changes
+        if (_smoothedProfile.size() != numberOfSamples) {
+            _smoothedProfile = QVector<float>(samples, samples + numberOfSamples);
+        }
+        for (int i = 0; i < numberOfSamples; i++) {
+            _smoothedProfile[i] = samples[i] * 0.2f + _smoothedProfile[i] * 0.8f;
+            _incomingProfile.samples[i] = static_cast<uint8_t>(_smoothedProfile[i] + 0.5f);
+        }
+    } else {
+        memcpy(_incomingProfile.samples.data(), samples, numberOfSamples);
+    }
+}
+
+bool WaterfallPlot::columnRows(const DepthScale& scale, float initialDepth, float length, int numberOfSamples,
+    int& virtualFloor, int& virtualHeight)
+{
+    virtualFloor = initialDepth * scale.pixelsPerMeter;
+    virtualHeight = length * scale.pixelsPerMeter * scale.dynamicScalar;
+
     // Do up/downsampling
-    float factor = points.length() / static_cast<float>(virtualHeight);
+    const float factor = numberOfSamples / static_cast<float>(virtualHeight);
 
     // Check if everything is correct before the draw
-    if (floor(factor * virtualHeight) > points.length() || factor * virtualHeight < 0) {
+    if (floor(factor * virtualHeight) > numberOfSamples || factor * virtualHeight < 0) {
         qCWarning(waterfallplot) << "Wrong factor !";
         qCDebug(waterfallplot).noquote() << QStringLiteral("virtualHeight: %1\t virtualFloor: %2\t factor: %3\t")
                                                 .arg(virtualHeight)
                                                 .arg(virtualFloor)
                                                 .arg(factor);
-        return;
+        return false;
     }
 
-    if (virtualFloor + virtualHeight > _image.height() || virtualFloor + virtualHeight < 0 || virtualFloor < 0) {
+    if (virtualFloor + virtualHeight > scale.imageHeight || virtualFloor + virtualHeight < 0 || virtualFloor < 0) {
         qCWarning(waterfallplot) << "Wrong Floor Height";
-        qCDebug(waterfallplot).noquote() << QStringLiteral(
-            "virtualFloor: %1\t virtualHeight: %2\t _minDepthToDrawInPixels: %3\t _maxDepthToDrawInPixels: %4")
+        qCDebug(waterfallplot).noquote() << QStringLiteral("virtualFloor: %1\t virtualHeight: %2\t imageHeight: %3")
                                                 .arg(virtualFloor)
                                                 .arg(virtualHeight)
-                                                .arg(_minDepthToDrawInPixels)
-                                                .arg(_maxDepthToDrawInPixels);
+                                                .arg(scale.imageHeight);
         qCDebug(waterfallplot).noquote() << QStringLiteral(
             "initPoint: %1\t length: %2\t _minPixelsPerMeter: %3\t dynamicPixelsPerMeterScalar: %4")
-                                                .arg(initPoint)
+                                                .arg(initialDepth)
                                                 .arg(length)
-                                                .arg(_minPixelsPerMeter)
-                                                .arg(dynamicPixelsPerMeterScalar);
-        return;
+                                                .arg(scale.pixelsPerMeter)
+                                                .arg(scale.dynamicScalar);
+        return false;
     }
+    return true;
+}
 
-    if (smooth()) {
-#pragma omp for
-        for (int i = 0; i < points.length(); i++) {
-            oldPoints[i] = points[i] * 0.2 + oldPoints[i] * 0.8;
-        }
+void WaterfallPlot::drawProfileColumn(QImage& image, QRegion& dirtyRegion, int column, const ProfileColumn& profile,
+    int virtualFloor, int virtualHeight, bool clearColumn)
+{
+    // Resample the column and write the colors directly in the image buffer
+    const float factor = profile.samples.size() / static_cast<float>(virtualHeight);
+    _columnSamples.resize(virtualHeight);
+    for (int i = 0; i < virtualHeight; i++) {
+        _columnSamples[i] = profile.samples[factor * i];
+    }
 
-#pragma omp for
-        for (int i = 0; i < virtualHeight; i++) {
-            _image.setPixelColor(_currentDrawIndex, i + virtualFloor, valueToRGB(oldPoints[factor * i]));
+    // The column is reused, the rows above and below the new profile should not keep the old one
+    if (clearColumn) {
+        const int stride = image.bytesPerLine() / sizeof(uint32_t);
+        uint32_t* const pixels = reinterpret_cast<uint32_t*>(image.bits()) + column;
+        for (int row = 0; row < virtualFloor; row++) {
+            pixels[row * stride] = 0;
         }
-    } else {
-#pragma omp for
-        for (int i = 0; i < virtualHeight; i++) {
-            _image.setPixelColor(_currentDrawIndex, i + virtualFloor, valueToRGB(points[factor * i]));
+        for (int row = virtualFloor + virtualHeight; row < image.height(); row++) {
+            pixels[row * stride] = 0;
         }
     }
-    _currentDrawIndex++; // This can get to be an issue at very fast update rates from ping
+    drawColumn(image, column, _columnSamples.constData(), virtualHeight, virtualFloor);
+    dirtyRegion += QRect(column, 0, 1, image.height());
+}
 
-    // Fix max update in 20Hz at max
-    if (!_updateTimer->isActive()) {
-        _updateTimer->start(50);
-    }
+void WaterfallPlot::rebuildColumns()
+{
+    qCDebug(waterfallplot) << "Rebuilding columns with depth scalar:" << _dynamicPixelsPerMeterScalar;
+    const DepthScale scale = depthScale();
+    _renderer.render([this, scale](QImage& image, QRegion& dirtyRegion) {
+        image.fill(Qt::transparent);
+        dirtyRegion += image.rect();
+        for (int column = 0; column < _columnProfiles.size(); column++) {
+            const auto& profile = _columnProfiles[column];
+            int virtualFloor = 0;
+            int virtualHeight = 0;
+            if (profile.samples.isEmpty()
+                || !columnRows(scale, profile.initialDepth, profile.length, profile.samples.size(), virtualFloor,
+                    virtualHeight)) {
+                continue;
+            }
+            // The image was already cleared
+            drawProfileColumn(image, dirtyRegion, column, profile, virtualFloor, virtualHeight, false);
+        }
+    });
 }
 
 void WaterfallPlot::updateMouseColumnData()
 {
-    static uint16_t first;
-    if (_currentDrawIndex < _displayWidth) {
-        first = 0;
-    } else {
-        first = _currentDrawIndex - _displayWidth;
-    }
-
     int widthPos = _mousePos.x() * _displayWidth / width();
-    _mousePos.setX(_mousePos.x() * _displayWidth / width() + first);
+    // Column in the ring buffer of the displayed frame, the oldest column is the next one to be written
+    _mousePos.setX((_frameDrawIndex + widthPos) % _renderer.imageSize().width());
     _mousePos.setY(_mousePos.y() * (_maxDepthToDrawInPixels - _minDepthToDrawInPixels) / height());
 
     // depth
@@ -304,3 +340,9 @@ void WaterfallPlot::updateMouseColumnData()
     emit mouseColumnConfidenceChanged();
     emit mouseColumnDepthChanged();
 }
+
+WaterfallPlot::~WaterfallPlot()
+{
+    // The render jobs use the members of this class
+    _renderer.stop();
+}
@@ -1,10 +1,14 @@
 #pragma once
 
 #include <QImage>
-#include <QQuickPaintedItem>
+#include <QQuickItem>
+
+#include <atomic>
 
 #include "logger.h"
+#include "profile.h"
 #include "ringvector.h"
+#include "slidingwindowextremum.h"
 #include "waterfall.h"
 #include "waterfallgradient.h"
 
@@ -26,12 +30,10 @@ public:
     WaterfallPlot(QQuickItem* parent = nullptr);
 
     /**
-     * @brief This is used by the qml pain event
-     *  This paint the waterfall in qml
+     * @brief Destroy the WaterfallPlot object
      *
-     * @param painter
      */
-    void paint(QPainter* painter) final override;
+    ~WaterfallPlot();
 
     /**
      * @brief Set the waterfall Image
@@ -56,16 +58,12 @@ public:
     Q_PROPERTY(float maxDepth READ maxDepth WRITE setMaxDepth)
 
     /**
-     * @brief Draw a list of points in the waterfall
+     * @brief Draw a profile in the waterfall
+     *  Samples, confidence, initial point, length and distance of the profile are used
      *
-     * @param points
-     * @param confidence
-     * @param initPoint
-     * @param length
-     * @param distance
+     * @param profile
      */
-    Q_INVOKABLE void draw(const QVector<double>& points, float confidence = 0, float initPoint = 0, float length = 50,
-        float distance = 0);
+    Q_INVOKABLE void draw(const Profile& profile);
 
     /**
      * @brief Clear waterfall and restart all parameters
@@ -78,7 +76,7 @@ public:
      *
      * @return QImage
      */
-    QImage image() { return _image; }
+    QImage image() { return _renderer.image(); }
     Q_PROPERTY(QImage image READ image WRITE setImage NOTIFY imageChanged)
 
     /**
@@ -127,6 +125,15 @@ signals:
     void mouseColumnDepthChanged();
     void mouseDepthChanged();
 
+protected:
+    /**
+     * @brief Return the visible window of the ring buffer image
+     *
+     * @param imageSize
+     * @return QVector<WaterfallNode::PaintRegion>
+     */
+    QVector<WaterfallNode::PaintRegion> paintRegions(const QSize& imageSize) const final override;
+
 private:
     Q_DISABLE_COPY(WaterfallPlot)
 
@@ -136,27 +143,140 @@ private:
      */
     void loadUserGradients();
 
+    /**
+     * @brief Normalized profile of a column
+     *  It's used to rebuild the column when the depth scale changes
+     *
+     */
+    struct ProfileColumn {
+        float initialDepth = 0;
+        float length = 0;
+        QVector<uint8_t> samples;
+    };
+
+    /**
+     * @brief Depth scale of the image, it's copied to the render jobs
+     *
+     */
+    struct DepthScale {
+        float pixelsPerMeter;
+        // Used when the depth range is too small to have more than one pixel per sample
+        float dynamicScalar;
+        int imageHeight;
+    };
+
+    /**
+     * @brief Part of the ring buffer image that is visible
+     *  The GUI thread can be ahead of the rendered image, the window is published with the frame
+     *
+     */
+    struct VisibleWindow {
+        // Next column to be written in the ring buffer image, it's also the oldest column
+        int drawIndex = 0;
+        float minDepthInPixels = 0;
+        float maxDepthInPixels = 0;
+    };
+
+    /**
+     * @brief Return the actual depth scale
+     *
+     * @return DepthScale
+     */
+    DepthScale depthScale() const
+    {
+        return {_minPixelsPerMeter, _dynamicPixelsPerMeterScalar, _renderer.imageSize().height()};
+    }
+
+    /**
+     * @brief Return the actual visible depths, the draw index is kept by the render worker
+     *
+     * @return VisibleWindow
+     */
+    VisibleWindow visibleWindow() const { return {0, _minDepthToDrawInPixels, _maxDepthToDrawInPixels}; }
+
+    /**
+     * @brief Calculate the rows of a profile column in the image
+     *
+     * @param scale
+     * @param initialDepth
+     * @param length
+     * @param numberOfSamples
+     * @param virtualFloor first row of the column
+     * @param virtualHeight number of rows of the column
+     * @return true
+     * @return false if the profile does not fit in the image
+     */
+    static bool columnRows(const DepthScale& scale, float initialDepth, float length, int numberOfSamples,
+        int& virtualFloor, int& virtualHeight);
+
+    /**
+     * @brief Draw a profile in a column of the image, called from the render worker
+     *  The column still has the profile drawn one lap before in the ring buffer, the rows outside of the new profile
+     *  are cleared when clearColumn is true
+     *
+     * @param image
+     * @param dirtyRegion
+     * @param column
+     * @param profile
+     * @param virtualFloor
+     * @param virtualHeight
+     * @param clearColumn false if the column is already clear
+     */
+    void drawProfileColumn(QImage& image, QRegion& dirtyRegion, int column, const ProfileColumn& profile,
+        int virtualFloor, int virtualHeight, bool clearColumn = true);
+
+    /**
+     * @brief Draw all columns again from the profile history with the actual depth scale
+     *  The cost is proportional to the number of columns and not to the image size
+     *
+     */
+    void rebuildColumns();
+
+    /**
+     * @brief Copy the profile samples to the incoming column, called from the render worker
+     *
+     * @param profile
+     * @param smooth filter the samples with the previous profiles
+     */
+    void updateIncomingProfile(const Profile& profile, bool smooth);
+
     /**
      * @brief Update mouse column information
      *
      */
     void updateMouseColumnData();
 
-    uint16_t _currentDrawIndex;
     static uint16_t _displayWidth;
-    QImage _image;
+    float _dynamicPixelsPerMeterScalar;
+    bool _inDynamic;
     float _maxDepthToDraw;
     float _maxDepthToDrawInPixels;
+    // Max and min depth of the last samples, updated in O(1) for each profile
+    SlidingWindowExtremum<float, std::greater<float>> _maxDepthWindow;
     float _minDepthToDraw;
     float _minDepthToDrawInPixels;
+    SlidingWindowExtremum<float, std::less<float>> _minDepthWindow;
     float _minPixelsPerMeter;
     float _mouseColumnConfidence;
     float _mouseColumnDepth;
     float _mouseDepth;
-    QPainter* _painter;
-    QTimer* _updateTimer;
     float _waterfallDepth;
 
+    // Only accessed by the render worker
+    // Profile of each column, it follows the same ring buffer indexes of the image
+    QVector<ProfileColumn> _columnProfiles;
+    // Hold the resampled column samples between draw calls, avoiding allocations
+    QVector<uint8_t> _columnSamples;
+    ProfileColumn _incomingProfile;
+    VisibleWindow _renderedWindow;
+    // Profile filtered with the previous ones when smooth is enabled
+    QVector<float> _smoothedProfile;
+
+    // Window of the published frame, protected by the renderer frame lock
+    VisibleWindow _frameWindow;
+    // Draw index of the published frame, read by the GUI thread without the frame lock
+    std::atomic<int> _frameDrawIndex;
+
     /**
      * @brief Depth and Confidence package
      *
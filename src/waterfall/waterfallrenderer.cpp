@@ -0,0 +1,154 @@
+#include <cstring>
+
+#include <QMutexLocker>
+
+#include "logger.h"
+#include "waterfallrenderer.h"
+
+PING_LOGGING_CATEGORY(waterfallrenderer, "ping.waterfallrenderer")
+
+WaterfallRenderer::WaterfallRenderer(QObject* parent)
+    : QObject(parent)
+    , _dropped(0)
+    , _queue(queueCapacity)
+    , _stop(false)
+{
+    _thread.reset(QThread::create([this] { run(); }));
+    _thread->setObjectName(QStringLiteral("WaterfallRenderer"));
+    _thread->start();
+}
+
+bool WaterfallRenderer::render(Job&& job)
+{
+    if (!_thread) {
+        return false;
+    }
+
+    // The job can't be lost, the worker is faster than the GUI thread in most cases and the wait is short
+    while (!_queue.push(std::move(job))) {
+        QThread::yieldCurrentThread();
+    }
+    _pending.release();
+    return true;
+}
+
+bool WaterfallRenderer::tryRender(Job&& job)
+{
+    if (!_thread) {
+        return false;
+    }
+
+    if (!_queue.push(std::move(job))) {
+        // Avoid a warning for each profile when the worker can't keep up
+        if (_dropped++ % 100 == 0) {
+            qCWarning(waterfallrenderer) << "Render queue is full, jobs dropped:" << _dropped;
+        }
+        return false;
+    }
+    _pending.release();
+    return true;
+}
+
+void WaterfallRenderer::setImage(const QImage& image)
+{
+    _imageSize = image.size();
+    render([image](QImage& backImage, QRegion& dirtyRegion) {
+        backImage = image;
+        dirtyRegion = backImage.rect();
+    });
+}
+
+QImage WaterfallRenderer::image() const
+{
+    QMutexLocker locker(&_frameMutex);
+    return _frontImage;
+}
+
+void WaterfallRenderer::readFrame(const std::function<void(const QImage& image, const QRegion& dirtyRegion)>& function)
+{
+    QMutexLocker locker(&_frameMutex);
+    function(_frontImage, _frontDirtyRegion);
+    _frontDirtyRegion = QRegion();
+}
+
+void WaterfallRenderer::run()
+{
+    Job job;
+    while (true) {
+        _pending.acquire();
+        if (_stop) {
+            return;
+        }
+
+        // The semaphore can be bigger than the queue size, since a batch can take more than one job
+        QRegion dirtyRegion;
+        for (int count = 0; count < maxBatchSize && _queue.pop(job); count++) {
+            QMutexLocker locker(&_jobMutex);
+            job(_backImage, dirtyRegion);
+        }
+
+        if (!dirtyRegion.isEmpty()) {
+            publish(dirtyRegion);
+        }
+
+        for (QSemaphore* semaphore : qAsConst(_idleSemaphores)) {
+            semaphore->release();
+        }
+        _idleSemaphores.clear();
+    }
+}
+
+void WaterfallRenderer::publish(const QRegion& dirtyRegion)
+{
+    {
+        QMutexLocker locker(&_frameMutex);
+        _frontImage.swap(_backImage);
+        _frontDirtyRegion += dirtyRegion;
+        if (_publishFunction) {
+            _publishFunction();
+        }
+    }
+
+    // The new back image is the previous frame, only the published changes are missing.
+    // The front image is only read by the other threads, it can be read without the lock.
+    if (_backImage.size() != _frontImage.size() || _backImage.format() != _frontImage.format()) {
+        _backImage = _frontImage.copy();
+    } else {
+        const int bytesPerPixel = _frontImage.depth() / 8;
+        for (const QRect& dirtyRect : dirtyRegion) {
+            const QRect rect = dirtyRect.intersected(_frontImage.rect());
+            for (int row = rect.top(); row <= rect.bottom(); row++) {
+                memcpy(_backImage.scanLine(row) + rect.x() * bytesPerPixel,
+                    _frontImage.constScanLine(row) + rect.x() * bytesPerPixel, rect.width() * bytesPerPixel);
+            }
+        }
+    }
+
+    emit frameReady();
+}
+
+void WaterfallRenderer::waitForIdle()
+{
+    if (!_thread) {
+        return;
+    }
+
+    // The jobs are executed in order, the semaphore is released after the frame of the previous jobs is published
+    QSemaphore idle;
+    render([this, &idle](QImage&, QRegion&) { _idleSemaphores.append(&idle); });
+    idle.acquire();
+}
+
+void WaterfallRenderer::stop()
+{
+    if (!_thread) {
+        return;
+    }
+
+    _stop = true;
+    _pending.release();
+    _thread->wait();
+    _thread.reset();
+}
+
+WaterfallRenderer::~WaterfallRenderer() { stop(); }
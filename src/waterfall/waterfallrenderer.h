@@ -0,0 +1,187 @@
+#pragma once
+
+#include <QImage>
+#include <QLoggingCategory>
+#include <QMutex>
+#include <QObject>
+#include <QRegion>
+#include <QSemaphore>
+#include <QSize>
+#include <QThread>
+#include <QVector>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+
+#include "spscqueue.h"
+
+Q_DECLARE_LOGGING_CATEGORY(waterfallrenderer)
+
+/**
+ * @brief Rasterize the waterfall images in a worker thread
+ *  Render jobs are added to a bounded lock-free queue by the GUI thread and executed by the worker over the back
+ *  image. When the queue is empty the back image is swapped with the front one, that is read by the scene graph.
+ *  The queue supports a single producer, render should always be called from the GUI thread.
+ *  Jobs that change the state of the image or of the plot are never dropped, render waits for the worker when the
+ *  queue is full. Only jobs that can be lost without consequences, like the draw of a single profile, are dropped.
+ *
+ */
+class WaterfallRenderer : public QObject {
+    Q_OBJECT
+public:
+    /**
+     * @brief Function executed by the worker, it should draw in the image and add the changed area to dirtyRegion
+     *
+     */
+    using Job = std::function<void(QImage& image, QRegion& dirtyRegion)>;
+
+    /**
+     * @brief Construct a new Waterfall Renderer object and start the worker thread
+     *
+     * @param parent
+     */
+    WaterfallRenderer(QObject* parent = nullptr);
+
+    /**
+     * @brief Destroy the Waterfall Renderer object, the worker is stopped
+     *
+     */
+    ~WaterfallRenderer();
+
+    /**
+     * @brief Queue a job to be executed by the worker, it waits for the worker while the queue is full
+     *  It should be used for jobs that change state, like clearing or replacing the image
+     *
+     * @param job
+     * @return false if the worker was stopped
+     */
+    bool render(Job&& job);
+
+    /**
+     * @brief Queue a job to be executed by the worker, the job is dropped if the queue is full
+     *  The job should not change state that the next jobs depend on, E.g: the draw of a profile
+     *
+     * @param job
+     * @return false if the job was dropped because the queue is full or the worker was stopped
+     */
+    bool tryRender(Job&& job);
+
+    /**
+     * @brief Return the number of jobs dropped because the queue was full
+     *  Should only be called from the GUI thread
+     *
+     * @return quint64
+     */
+    quint64 dropped() const { return _dropped; }
+
+    /**
+     * @brief Replace the image used by the next jobs, the change is visible when the frame is published
+     *
+     * @param image
+     */
+    void setImage(const QImage& image);
+
+    /**
+     * @brief Return the size of the image used by the queued jobs
+     *  Should only be called from the GUI thread
+     *
+     * @return QSize
+     */
+    QSize imageSize() const { return _imageSize; }
+
+    /**
+     * @brief Return a copy of the last published frame
+     *
+     * @return QImage
+     */
+    QImage image() const;
+
+    /**
+     * @brief Give access to the last published frame and the region changed since the previous call
+     *  The worker can't publish a new frame while the function runs
+     *
+     * @param function
+     */
+    void readFrame(const std::function<void(const QImage& image, const QRegion& dirtyRegion)>& function);
+
+    /**
+     * @brief Set a function called by the worker when a frame is published, while the frame can't be read
+     *  It should be used to publish the worker state that describes the frame (E.g: ring buffer position)
+     *  Should be set before the first job is queued
+     *
+     * @param function
+     */
+    void setPublishFunction(std::function<void()>&& function) { _publishFunction = std::move(function); }
+
+    /**
+     * @brief Wait until the worker executes the queued jobs and publishes their frame
+     *  Should only be called from the GUI thread, E.g: to read the final image without a window
+     *
+     */
+    void waitForIdle();
+
+    /**
+     * @brief Stop the worker, queued jobs are discarded
+     *  Items that own state used by the jobs should stop the renderer before the state is destroyed
+     *
+     */
+    void stop();
+
+    /**
+     * @brief Return the mutex held by the worker while a job runs
+     *  It should be locked to change data that is shared with the jobs (E.g: color table)
+     *
+     * @return QMutex*
+     */
+    QMutex* jobMutex() { return &_jobMutex; }
+
+    // Maximum number of jobs executed before a frame is published
+    static constexpr int maxBatchSize = 64;
+    static constexpr int queueCapacity = 1024;
+
+signals:
+    /**
+     * @brief A new frame was published, it's emitted from the worker thread
+     *
+     */
+    void frameReady();
+
+private:
+    Q_DISABLE_COPY(WaterfallRenderer)
+
+    /**
+     * @brief Worker thread loop
+     *
+     */
+    void run();
+
+    /**
+     * @brief Swap the back image with the front one and update the new back image with the published changes
+     *
+     * @param dirtyRegion changed area of the back image
+     */
+    void publish(const QRegion& dirtyRegion);
+
+    // Only accessed by the GUI thread
+    quint64 _dropped;
+    // Only accessed by the worker, waitForIdle calls released after the next publish
+    QVector<QSemaphore*> _idleSemaphores;
+    QSize _imageSize;
+
+    // Protected by _frameMutex
+    QImage _frontImage;
+    QRegion _frontDirtyRegion;
+    mutable QMutex _frameMutex;
+
+    // Only accessed by the worker thread
+    QImage _backImage;
+    std::function<void()> _publishFunction;
+
+    QMutex _jobMutex;
+    // Number of queued jobs, the worker sleeps while it's zero
+    QSemaphore _pending;
+    SpscQueue<Job> _queue;
+    std::atomic<bool> _stop;
+    std::unique_ptr<QThread> _thread;
+};
@@ -0,0 +1,57 @@
+#!/bin/bash
+
+# Variables
+bold=$(tput bold)
+normal=$(tput sgr0)
+scriptpath="$( cd "$(dirname "$0")" ; pwd -P )"
+projectpath=${scriptpath}/..
+scriptname=$(basename "$0")
+baselineref=$1
+buildfolder="$projectpath/build_benchmark"
+baselinefolder="$projectpath/build_benchmark_baseline"
+baselinefile="$baselinefolder/baseline.json"
+
+# Functions
+echob() {
+    echo "${bold}${1}${normal}"
+}
+
+usage() {
+    echo "USAGE: $scriptname [BASELINE_GIT_REF]"
+    echo "The benchmarks of BASELINE_GIT_REF are used as baseline, a slower result fails."
+}
+
+# Build the benchmark of a source folder in release mode
+# $1: Source folder
+# $2: Build folder
+build() {
+    rm -rf $2
+    cmake -S $1 -B $2 -DCMAKE_BUILD_TYPE=Release && cmake --build $2 --parallel --config Release --target benchmark
+}
+
+if [ "$1" == "--help" ]; then
+    usage
+    exit 0
+fi
+
+unset PING_BENCHMARK_BASELINE
+
+# The baseline runs in the same machine, the results can be compared
+if [ -n "$baselineref" ]; then
+    echob "Run baseline benchmarks of $baselineref:"
+    baselinesource=$(mktemp -d)
+    git -C $projectpath worktree add --detach $baselinesource $baselineref || exit 1
+    git -C $baselinesource submodule update --init --recursive
+    if grep -q "add_executable(benchmark" $baselinesource/src/CMakeLists.txt; then
+        build $baselinesource $baselinefolder || exit 1
+        PING_BENCHMARK_OUTPUT=$baselinefile $baselinefolder/benchmark || exit 1
+        export PING_BENCHMARK_BASELINE=$baselinefile
+    else
+        echob "There are no benchmarks in $baselineref, results are not compared."
+    fi
+    git -C $projectpath worktree remove --force $baselinesource
+fi
+
+echob "Run benchmarks:"
+build $projectpath $buildfolder || exit 1
+PING_BENCHMARK_OUTPUT=$buildfolder/result.json $buildfolder/benchmark || exit 1